@@ -1,14 +1,26 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <source/command_list.h>
+#include <source/gl_state.h>
+#include <source/render_queue.h>
 #include <source/shader.h>
+#include <source/shader_variants.h>
+#include <source/text_layer.h>
 #include <stdlib.h>
 
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <glm/glm.hpp>
 #include <iostream>
+#include <random>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "config.h"
 #include "mandelbrot.h"
@@ -40,12 +52,693 @@ BenchmarkStats run_impl(GLFWwindow* window)
     vao.begin();
     getVertexData(vertices, colors, xCubes, yCubes, screenWidth, screenHeight);
 
+    const AttributeBinding* attribs[2] = {posAttrib, colorAttrib};
+    const void* data[2] = {vertices, colors};
+
+    ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        vao.addData(attribs, data, 2, numVertex, 0);
+        vao.end();
+        vao.render(0, numVertex);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Regenerates cube geometry each frame, once through staging arrays (`staged`) and once written
+/// in place into buffer storage.
+BenchmarkStats run_generate(GLFWwindow* window, bool staged)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numVertex = xCubes * yCubes * 36;
+
+    VertexBuffer buf(numVertex * 4 * sizeof(GLfloat));
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* colorAttrib = vao.bindBuffer(&colorFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    MandelBrot mandel(-2.0, 1.0, -1.0, 1.0, xCubes, yCubes, 255);
+    const float* pixelData = mandel.calculate();
+
+    GLfloat* vertices = staged ? new GLfloat[numVertex * 3] : nullptr;
+    GLfloat* colors = staged ? new GLfloat[numVertex * 1] : nullptr;
+
+    ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        vao.begin();
+        if (staged) {
+            getVertexData(pixelData, VertexView<GLfloat>(vertices, 3 * sizeof(GLfloat), numVertex),
+                VertexView<GLfloat>(colors, sizeof(GLfloat), numVertex), xCubes, yCubes,
+                screenWidth, screenHeight);
+            vao.addData(posAttrib, vertices, numVertex, 0);
+            vao.addData(colorAttrib, colors, numVertex, 0);
+        }
+        else {
+            getVertexData(pixelData, vao.reserve<GLfloat>(posAttrib, numVertex),
+                vao.reserve<GLfloat>(colorAttrib, numVertex), xCubes, yCubes, screenWidth,
+                screenHeight);
+        }
+        vao.end();
+        vao.render(0, numVertex);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Draws a single cube mesh once per mandelbrot value, only per instance offset and color are
+/// uploaded each frame.
+BenchmarkStats run_instanced(GLFWwindow* window)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numInstances = xCubes * yCubes;
+
+    VertexBuffer meshBuf(36 * 3 * sizeof(GLfloat));
+    VertexBuffer instanceBuf(numInstances * 3 * sizeof(GLfloat));
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VertexAttribute offsetFmt = {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &meshBuf, sizeof(GLfloat));
+    const AttributeBinding* colorAttrib =
+        vao.bindBuffer(&colorFmt, 1, &instanceBuf, sizeof(GLfloat), 1);
+    const AttributeBinding* offsetAttrib =
+        vao.bindBuffer(&offsetFmt, 2, &instanceBuf, sizeof(GLfloat), 1);
+    vao.initialize();
+
+    GLfloat mesh[36 * 3];
+    GLfloat* offsets = new GLfloat[numInstances * 2];
+    GLfloat* colors = new GLfloat[numInstances * 1];
+    getInstanceData(mesh, offsets, colors, xCubes, yCubes, screenWidth, screenHeight);
+
+    vao.addData(posAttrib, mesh, 36, 0);
+
+    const AttributeBinding* attribs[2] = {colorAttrib, offsetAttrib};
+    const void* data[2] = {colors, offsets};
+
+    ShaderProgram shader(readFile("../shaders/benchmark_instanced.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        vao.addData(attribs, data, 2, numInstances, 0);
+        vao.end();
+        vao.renderInstanced(0, 36, numInstances);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] offsets;
+
+    return result;
+}
+
+
+/// Same as `run_impl` but stores positions as normalized shorts and colors as normalized unsigned
+/// shorts, halving vertex size.
+BenchmarkStats run_packed(GLFWwindow* window)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numVertex = xCubes * yCubes * 36;
+
+    VertexBuffer buf(numVertex * 4 * sizeof(GLshort));
+    VertexAttribute posFmt = {3, GL_SHORT, GL_TRUE};
+    VertexAttribute colorFmt = {1, GL_UNSIGNED_SHORT, GL_TRUE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf);
+    const AttributeBinding* colorAttrib = vao.bindBuffer(&colorFmt, 1, &buf);
+    vao.initialize();
+
+    GLfloat* vertices = new GLfloat[numVertex * 3];
+    GLfloat* colors = new GLfloat[numVertex * 1];
+    getVertexData(vertices, colors, xCubes, yCubes, screenWidth, screenHeight);
+
+    ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        vao.addConverted(posAttrib, vertices, numVertex, 0);
+        vao.addConverted(colorAttrib, colors, numVertex, 0);
+        vao.end();
+        vao.render(0, numVertex);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Same as `run_impl` but uploads welded vertices and draws them indexed.
+/// @param optimize Reorder triangles and vertices for vertex cache, overdraw and vertex fetch.
+BenchmarkStats run_indexed(GLFWwindow* window, bool optimize)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numVertex = xCubes * yCubes * 36;
+    std::size_t stride = 4 * sizeof(GLfloat);
+
+    GLfloat* vertices = new GLfloat[numVertex * 3];
+    GLfloat* colors = new GLfloat[numVertex * 1];
+    getVertexData(vertices, colors, xCubes, yCubes, screenWidth, screenHeight);
+
+    GLfloat* interleaved = new GLfloat[numVertex * 4];
+    InterleaveStream streams[2] = {
+        {vertices, 3 * sizeof(GLfloat), 0}, {colors, sizeof(GLfloat), 3 * sizeof(GLfloat)}};
+    interleave(reinterpret_cast<std::uint8_t*>(interleaved), stride, streams, 2, numVertex);
+
+    std::uint32_t* indices = new std::uint32_t[numVertex];
+    std::size_t numUnique = weldVertices(interleaved, numVertex, stride, interleaved, indices);
+    std::cout << "Welded " << numVertex << " to " << numUnique << " vertices ("
+              << numVertex * stride << " -> " << numUnique * stride << " vertex bytes)"
+              << std::endl;
+
+    if (optimize) {
+        auto printReport = [](const char* step, const OptimizationReport& report) {
+            std::cout << step << ": ACMR " << report.before.acmr << " -> " << report.after.acmr
+                      << ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+                      << std::endl;
+        };
+
+        printReport("Vertex cache", optimizeVertexCache(indices, numVertex, numUnique));
+        printReport("Overdraw",
+            optimizeOverdraw(indices, numVertex, interleaved, stride, numUnique));
+        numUnique = optimizeVertexFetch(interleaved, numUnique, stride, indices, numVertex);
+    }
+
+    VertexBuffer buf(numUnique * stride);
+    IndexBuffer indexBuf;
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    vao.bindBuffer(&colorFmt, 1, &buf, sizeof(GLfloat));
+    vao.bindIndices(&indexBuf);
+    vao.initialize();
+
     ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
         readFile("../shaders/benchmark.fragmentshader").c_str());
 
     glClearColor(0.0, 0.0, 0.0, 0.0f);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        buf.add(interleaved, numUnique * stride, stride, 0, 0);
+        indexBuf.add(indices, numVertex, 0);
+        vao.end();
+        vao.renderIndexed(0, numVertex);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] indices;
+    delete[] interleaved;
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Same as `run_impl` but writes vertex data directly into persistently mapped GPU memory.
+BenchmarkStats run_streaming(GLFWwindow* window)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numVertex = xCubes * yCubes * 36;
+
+    StreamingBuffer buf(numVertex * 4 * sizeof(GLfloat));
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STREAM_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* colorAttrib = vao.bindBuffer(&colorFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    GLfloat* vertices = new GLfloat[numVertex * 3];
+    GLfloat* colors = new GLfloat[numVertex * 1];
+    getVertexData(vertices, colors, xCubes, yCubes, screenWidth, screenHeight);
+
+    ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        clock_t start = clock();
+        vao.begin();
+        vao.addData(posAttrib, vertices, numVertex, 0);
+        vao.addData(colorAttrib, colors, numVertex, 0);
+        vao.end();
+        vao.render(0, numVertex);
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Updates `percent` % of vertices each frame, moving the updated range through the buffer.
+BenchmarkStats run_partial(GLFWwindow* window, unsigned int percent)
+{
+    unsigned int screenWidth = 780;
+    unsigned int screenHeight = 780;
+    unsigned int xCubes = 780;
+    unsigned int yCubes = 780;
+
+    assert(screenWidth % xCubes == 0);
+    assert(screenHeight % yCubes == 0);
+    unsigned int numVertex = xCubes * yCubes * 36;
+    unsigned int numUpdate = (unsigned int)((unsigned long long)numVertex * percent / 100);
+
+    VertexBuffer buf(numVertex * 4 * sizeof(GLfloat));
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_DYNAMIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* colorAttrib = vao.bindBuffer(&colorFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    GLfloat* vertices = new GLfloat[numVertex * 3];
+    GLfloat* colors = new GLfloat[numVertex * 1];
+    getVertexData(vertices, colors, xCubes, yCubes, screenWidth, screenHeight);
+
+    vao.begin();
+    vao.addData(posAttrib, vertices, numVertex, 0);
+    vao.addData(colorAttrib, colors, numVertex, 0);
+    vao.end();
+
+    ShaderProgram shader(readFile("../shaders/benchmark.vertexshader").c_str(),
+        readFile("../shaders/benchmark.fragmentshader").c_str());
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    unsigned int first = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        if (first + numUpdate > numVertex) {
+            first = 0;
+        }
+
+        clock_t start = clock();
+        vao.begin();
+        vao.addData(posAttrib, vertices + first * 3, numUpdate, first);
+        vao.addData(colorAttrib, colors + first, numUpdate, first);
+        vao.end();
+        vao.render(0, numVertex);
+        clock_t end = clock();
+
+        first += numUpdate;
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    delete[] colors;
+    delete[] vertices;
+
+    return result;
+}
+
+
+/// Draws 10k retained labels, `percent` of them change their text each frame.
+BenchmarkStats run_text(GLFWwindow* window, unsigned int percent)
+{
+    unsigned int xLabels = 100;
+    unsigned int yLabels = 100;
+    unsigned int numLabels = xLabels * yLabels;
+    unsigned int numUpdate = numLabels * percent / 100;
+
+    VertexBuffer buf(1);
+    VertexAttribute posFmt = {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute uvFmt = {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_DYNAMIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* uvAttrib = vao.bindBuffer(&uvFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0, GlyphMode::SDF);
+    TextLayer layer(&font, posAttrib, uvAttrib, numLabels * 16 * 6);
+
+    float width = 2.0f / xLabels;
+    float height = 2.0f / yLabels;
+    char text[16];
+    std::vector<TextObject*> labels(numLabels);
+    for (unsigned int i = 0; i < numLabels; i++) {
+        float x = -1.0f + (i % xLabels) * width;
+        float y = -1.0f + (i / xLabels) * height;
+        std::snprintf(text, sizeof(text), "L%u", i);
+        labels[i] = layer.create(text, x, y, x + width, y + height);
+    }
+    vao.end();
+
+    ShaderVariants variants("../shaders/benchmark_text.vertexshader",
+        "../shaders/benchmark_text.fragmentshader", {"SDF"});
+    ShaderProgram& shader = *variants.get(variants.bit("SDF"));
+    const GLint textureIdx = 0;
+    shader.uniform<GLint>("textureSampler").set(textureIdx);
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::activeTexture(GL_TEXTURE0);
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    unsigned int first = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        shader.use();
+
+        if (first + numUpdate > numLabels) {
+            first = 0;
+        }
+
+        clock_t start = clock();
+        for (unsigned int i = first; i < first + numUpdate; i++) {
+            std::snprintf(text, sizeof(text), "%u:%d", i, counter);
+            labels[i]->setText(text);
+        }
+        vao.end();
+
+        for (std::map<GLuint, DrawBatch>::value_type& v : layer.batches()) {
+            GLState::bindTexture(GL_TEXTURE_2D, v.first);
+            vao.renderMulti(v.second);
+        }
+        clock_t end = clock();
+
+        first += numUpdate;
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    return result;
+}
+
+
+/// Lays out long strings with `TextRender::add`, measures glyph lookup and layout only.
+BenchmarkStats run_layout(GLFWwindow* window, bool utf8)
+{
+    // "Grüße € été Å" mixes one, two and three byte sequences
+    const char* alphabet = utf8 ? "Gr\xC3\xBC\xC3\x9F" "e \xE2\x82\xAC \xC3\xA9t\xC3\xA9 \xC3\x85"
+                                : "Hello World! 0123";
+    std::string text;
+    while (text.size() < 10000) {
+        text += alphabet;
+    }
+
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0);
+    font.add(text.c_str(), -1.0f, -1.0f, 1.0f, 1.0f);    // Rasterise glyphs before timing
+    font.clear();
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        clock_t start = clock();
+        for (int i = 0; i < 10; i++) {
+            font.add(text.c_str(), -1.0f, -1.0f, 1.0f, 1.0f);
+        }
+        font.clear();
+        clock_t end = clock();
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    return result;
+}
+
+
+/// Lays out and uploads 36k glyphs each frame, either as 6 vertices or as one instance per glyph.
+BenchmarkStats run_glyphs(GLFWwindow* window, bool instanced)
+{
+    unsigned int xLabels = 20;
+    unsigned int yLabels = 100;
+    const char* label = "Text 0123456789 abcd";    // 18 glyphs
+
+    VertexBuffer buf(1);
+    VertexAttribute posFmt = {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute uvFmt = {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute sizeFmt = {2, GL_HALF_FLOAT, GL_FALSE};
+    VertexAttribute glyphFmt = {1, GL_UNSIGNED_INT, GL_FALSE};
+    VAO vao(GL_STREAM_DRAW);
+    if (instanced) {
+        vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat), 1);
+        vao.bindBuffer(&sizeFmt, 1, &buf, sizeof(GLhalf), 1);
+        vao.bindBuffer(&glyphFmt, 2, &buf, sizeof(GLuint), 1);
+    }
+    const AttributeBinding* posAttrib =
+        instanced ? nullptr : vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* uvAttrib =
+        instanced ? nullptr : vao.bindBuffer(&uvFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0, GlyphMode::SDF);
+    font.prewarm(label);
+
+    std::string vertexShader = instanced ? "../shaders/benchmark_text_instanced.vertexshader"
+                                         : "../shaders/benchmark_text.vertexshader";
+    ShaderVariants variants(vertexShader, "../shaders/benchmark_text.fragmentshader", {"SDF"});
+    ShaderProgram& shader = *variants.get(variants.bit("SDF"));
+    const GLint textureIdx = 0;
+    const GLint uvTableIdx = 1;
+    shader.uniform<GLint>("textureSampler").set(textureIdx);
+    if (instanced) {
+        shader.uniform<GLint>("glyphUVs").set(uvTableIdx);
+    }
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLuint textures[4];
+    unsigned int offsets[4];
+    float width = 2.0f / xLabels;
+    float height = 2.0f / yLabels;
 
     clock_t deltaTime = 0.0;
     BenchmarkStats result;
@@ -53,15 +746,49 @@ BenchmarkStats run_impl(GLFWwindow* window)
     do {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+        GLState::resetCounters();
         shader.use();
 
         clock_t start = clock();
-        vao.addData(posAttrib, vertices, numVertex, 0);
-        vao.addData(colorAttrib, colors, numVertex, 0);
+        font.clear();
+        for (unsigned int i = 0; i < xLabels * yLabels; i++) {
+            float x = -1.0f + (i % xLabels) * width;
+            float y = -1.0f + (i / xLabels) * height;
+            font.add(label, x, y, x + width, y + height);
+        }
+
+        unsigned int numTextures = instanced ? font.drawInstanced(&buf, textures, offsets, 0)
+                                             : font.draw(posAttrib, uvAttrib, textures, offsets, 0);
         vao.end();
-        vao.render(0, numVertex);
+
+        if (instanced) {
+            GLState::bindTexture(GL_TEXTURE1, GL_TEXTURE_BUFFER, font.uvTexture());
+        }
+
+        std::size_t dataSize = buf.size();
+        for (unsigned int i = 0; i < numTextures; i++) {
+            std::size_t recordSize = instanced ? sizeof(TextRender::GlyphInstance) : 16;
+            std::size_t end = i + 1 < numTextures ? offsets[i + 1] : dataSize / recordSize;
+
+            GLState::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[i]);
+            if (instanced) {
+                vao.renderInstanced(0, 6, end - offsets[i], offsets[i]);
+            }
+            else {
+                vao.render(offsets[i], end - offsets[i]);
+            }
+        }
         clock_t end = clock();
 
+        if (counter == 0) {
+            std::cout << "Bytes uploaded per frame: " << dataSize << std::endl;
+        }
+        else if (counter == 1) {
+            GLStateCounters calls = GLState::counters();
+            std::cout << "GL state calls per frame: " << calls.issued << " issued, "
+                      << calls.skipped << " skipped" << std::endl;
+        }
+
         deltaTime = end - start;
         result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
         counter++;
@@ -75,8 +802,402 @@ BenchmarkStats run_impl(GLFWwindow* window)
              glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
     std::cout << std::endl;
 
-    delete[] colors;
-    delete[] vertices;
+    return result;
+}
+
+
+/// Returns `count` distinct variants of the benchmark vertex and fragment shader pair.
+/// @param salt Added to sources, so drivers can not reuse programs compiled by earlier runs.
+std::vector<std::pair<std::string, std::string>> programSources(unsigned int count, long long salt)
+{
+    std::string vertexSource = readFile("../shaders/benchmark.vertexshader");
+    std::string fragmentSource = readFile("../shaders/benchmark.fragmentshader");
+
+    std::vector<std::pair<std::string, std::string>> sources;
+    for (unsigned int i = 0; i < count; i++) {
+        std::string tag =
+            "\n// variant " + std::to_string(i) + " " + std::to_string(salt) + "\n";
+        sources.emplace_back(vertexSource + tag, fragmentSource + tag);
+    }
+
+    return sources;
+}
+
+
+/// Creates 50 programs per frame, from an empty program cache (`warm == false`) or from binaries
+/// cached by an earlier pass. Measures wall clock time, as drivers may compile on own threads.
+BenchmarkStats run_programs(GLFWwindow* window, bool warm)
+{
+    const unsigned int numPrograms = 50;
+    const int numRuns = 10;
+    std::string cacheDirectory = "program_cache";
+
+    std::filesystem::remove_all(cacheDirectory);
+    ShaderProgram::setCacheDirectory(cacheDirectory);
+
+    // Drivers may keep their own on disk cache across processes
+    long long salt = std::chrono::system_clock::now().time_since_epoch().count();
+    std::vector<std::pair<std::string, std::string>> sources = programSources(numPrograms, salt);
+    if (warm) {
+        for (const std::pair<std::string, std::string>& source : sources) {
+            ShaderProgram program(source.first.c_str(), source.second.c_str());
+        }
+    }
+
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        if (!warm) {
+            std::filesystem::remove_all(cacheDirectory);
+            sources = programSources(numPrograms, salt + counter + 1);
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        {
+            std::vector<ShaderProgram*> programs;
+            for (const std::pair<std::string, std::string>& source : sources) {
+                programs.push_back(new ShaderProgram(source.first.c_str(), source.second.c_str()));
+            }
+            // Binary upload may be deferred until first use
+            for (ShaderProgram* program : programs) {
+                program->use();
+            }
+            glFinish();
+
+            for (ShaderProgram* program : programs) {
+                delete program;
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        result.addFramedata(std::chrono::duration<double>(end - start).count() * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < numRuns);
+    std::cout << std::endl;
+
+    ShaderProgram::setCacheDirectory("");
+    std::filesystem::remove_all(cacheDirectory);
+
+    return result;
+}
+
+
+/// Creates 50 programs per frame, one after another (`async == false`) or all submitted before
+/// waiting for any. Program cache is disabled, so every program is compiled from source.
+BenchmarkStats run_compile(GLFWwindow* window, bool async)
+{
+    const unsigned int numPrograms = 50;
+    const int numRuns = 10;
+    long long salt = std::chrono::system_clock::now().time_since_epoch().count();
+
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        // New sources each run, so drivers can not reuse programs of earlier runs
+        std::vector<std::pair<std::string, std::string>> sources =
+            programSources(numPrograms, salt + counter);
+        std::vector<ShaderProgram*> programs;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (async) {
+            std::vector<PendingProgram> pending;
+            for (const std::pair<std::string, std::string>& source : sources) {
+                pending.push_back(
+                    ShaderProgram::createAsync(source.first.c_str(), source.second.c_str()));
+            }
+
+            while (programs.size() < numPrograms) {
+                for (PendingProgram& program : pending) {
+                    if (program.ready()) {
+                        ShaderProgram* finished = program.get();
+                        if (finished != nullptr) {
+                            programs.push_back(finished);
+                        }
+                    }
+                }
+            }
+        }
+        else {
+            for (const std::pair<std::string, std::string>& source : sources) {
+                programs.push_back(new ShaderProgram(source.first.c_str(), source.second.c_str()));
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        for (ShaderProgram* program : programs) {
+            delete program;
+        }
+
+        result.addFramedata(std::chrono::duration<double>(end - start).count() * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < numRuns);
+    std::cout << std::endl;
+
+    return result;
+}
+
+
+/// Draws 10k small ranges per frame with random program, texture and VAO, either in submission
+/// order (`sorted == false`) or through a `RenderQueue`.
+BenchmarkStats run_queue(GLFWwindow* window, bool sorted)
+{
+    const unsigned int numPrograms = 8;
+    const unsigned int numTextures = 16;
+    const unsigned int numVAOs = 4;
+    const unsigned int numDraws = 10000;
+    const unsigned int numVertex = 600;
+
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    std::vector<GLfloat> vertices(numVertex * 3, 0.0f);
+    std::vector<GLfloat> colors(numVertex, 0.0f);
+    std::vector<VertexBuffer*> buffers;
+    std::vector<VAO*> vaos;
+    for (unsigned int i = 0; i < numVAOs; i++) {
+        buffers.push_back(new VertexBuffer(1));
+        vaos.push_back(new VAO(GL_STATIC_DRAW));
+        const AttributeBinding* posAttrib =
+            vaos[i]->bindBuffer(&posFmt, 0, buffers[i], sizeof(GLfloat));
+        const AttributeBinding* colorAttrib =
+            vaos[i]->bindBuffer(&colorFmt, 1, buffers[i], sizeof(GLfloat));
+        vaos[i]->initialize();
+
+        vaos[i]->begin();
+        vaos[i]->addData(posAttrib, vertices.data(), numVertex);
+        vaos[i]->addData(colorAttrib, colors.data(), numVertex);
+        vaos[i]->end();
+    }
+
+    std::vector<ShaderProgram*> programs;
+    for (const std::pair<std::string, std::string>& source : programSources(numPrograms, 0)) {
+        programs.push_back(new ShaderProgram(source.first.c_str(), source.second.c_str()));
+    }
+
+    GLuint textures[numTextures];
+    glGenTextures(numTextures, textures);
+    const GLubyte texel[4] = {255, 255, 255, 255};
+    for (unsigned int i = 0; i < numTextures; i++) {
+        GLState::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    }
+
+    RenderState state = {false, GL_ONE, GL_ZERO, true, GL_LESS};
+    std::mt19937 rng(42);
+    std::vector<DrawItem> items;
+    for (unsigned int i = 0; i < numDraws; i++) {
+        unsigned int program = rng() % numPrograms;
+        unsigned int texture = rng() % numTextures;
+        unsigned int vao = rng() % numVAOs;
+        std::uint64_t key = RenderQueue::makeKey(0, program, 0, texture, vao);
+        items.push_back({key, programs[program], vaos[vao], {textures[texture]}, state,
+            (i % (numVertex / 6)) * 6, 6, false, 0});
+    }
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    RenderQueue queue;
+
+    clock_t deltaTime = 0.0;
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        GLState::resetCounters();
+
+        clock_t start = clock();
+        if (sorted) {
+            for (const DrawItem& item : items) {
+                queue.submit(item);
+            }
+            queue.flush();
+        }
+        else {
+            for (const DrawItem& item : items) {
+                item.program->use();
+                GLState::bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, item.textures[0]);
+                GLState::enable(GL_DEPTH_TEST);
+                GLState::depthFunc(GL_LESS);
+                item.vao->render(item.first, item.count);
+            }
+        }
+        glFinish();
+        clock_t end = clock();
+
+        if (counter == 1) {
+            GLStateCounters calls = GLState::counters();
+            std::cout << "GL state calls per frame: " << calls.issued << " issued, "
+                      << calls.skipped << " skipped" << std::endl;
+            if (sorted) {
+                const RenderQueueStats& before = queue.unsortedStats();
+                const RenderQueueStats& after = queue.sortedStats();
+                std::cout << "Draw calls: " << before.drawCalls << " -> " << after.drawCalls
+                          << ", program changes: " << before.programChanges << " -> "
+                          << after.programChanges << ", texture changes: "
+                          << before.textureChanges << " -> " << after.textureChanges
+                          << ", VAO changes: " << before.vaoChanges << " -> "
+                          << after.vaoChanges << std::endl;
+            }
+        }
+
+        deltaTime = end - start;
+        result.addFramedata(deltaTime / (double)CLOCKS_PER_SEC * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    GLState::deleteTextures(numTextures, textures);
+    for (ShaderProgram* program : programs) {
+        delete program;
+    }
+    for (unsigned int i = 0; i < numVAOs; i++) {
+        delete vaos[i];
+        delete buffers[i];
+    }
+
+    return result;
+}
+
+
+/// Records 100k draws per frame, each with its own uniform value, split evenly over `numThreads`
+/// command lists. Lists are recorded in parallel, the calling thread records the first one, and
+/// replayed in list order. Measures wall clock time of recording and replay.
+BenchmarkStats run_commands(GLFWwindow* window, unsigned int numThreads)
+{
+    const unsigned int numDraws = 100000;
+    const unsigned int numPrograms = 4;
+    const unsigned int numTextures = 8;
+    const unsigned int numVertex = 600;
+
+    VertexBuffer buf(1);
+    VertexAttribute posFmt = {3, GL_FLOAT, GL_FALSE};
+    VertexAttribute colorFmt = {1, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* posAttrib = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    const AttributeBinding* colorAttrib = vao.bindBuffer(&colorFmt, 1, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    std::vector<GLfloat> vertices(numVertex * 3, 0.0f);
+    std::vector<GLfloat> colors(numVertex, 0.0f);
+    vao.begin();
+    vao.addData(posAttrib, vertices.data(), numVertex);
+    vao.addData(colorAttrib, colors.data(), numVertex);
+    vao.end();
+
+    std::string vertexSource = readFile("../shaders/benchmark_offset.vertexshader");
+    std::string fragmentSource = readFile("../shaders/benchmark.fragmentshader");
+    std::vector<ShaderProgram*> programs;
+    std::vector<UniformHandle<glm::vec2>> offsets;
+    for (unsigned int i = 0; i < numPrograms; i++) {
+        std::string tag = "\n// variant " + std::to_string(i) + "\n";
+        programs.push_back(
+            new ShaderProgram((vertexSource + tag).c_str(), (fragmentSource + tag).c_str()));
+        offsets.push_back(programs[i]->uniform<glm::vec2>("offset"));
+    }
+
+    GLuint textures[numTextures];
+    glGenTextures(numTextures, textures);
+
+    // Sized for a frame up front, recording does not allocate
+    std::vector<CommandList*> lists;
+    for (unsigned int i = 0; i < numThreads; i++) {
+        std::size_t draws = numDraws / numThreads + 1;
+        lists.push_back(new CommandList(draws * 4, draws * sizeof(glm::vec2)));
+    }
+
+    std::function<void(unsigned int)> record = [&](unsigned int thread) {
+        CommandList* list = lists[thread];
+        list->clear();
+
+        unsigned int first = numDraws * thread / numThreads;
+        unsigned int last = numDraws * (thread + 1) / numThreads;
+        for (unsigned int i = first; i < last; i++) {
+            // Program and texture change every 1000 draws
+            unsigned int group = i / 1000;
+            if (i == first || i % 1000 == 0) {
+                list->use(programs[group % numPrograms]);
+                list->bindTexture(GL_TEXTURE0, GL_TEXTURE_2D, textures[group % numTextures]);
+            }
+
+            glm::vec2 offset((i % 316) / 316.0f, (i / 316) / 316.0f);
+            list->setUniform(offsets[group % numPrograms], offset);
+            list->render(&vao, (i % (numVertex / 6)) * 6, 6);
+        }
+    };
+
+    glClearColor(0.0, 0.0, 0.0, 0.0f);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LESS);
+
+    BenchmarkStats result;
+    int counter = 0;
+    do {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < numThreads; i++) {
+            threads.emplace_back(record, i);
+        }
+        record(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::chrono::steady_clock::time_point recorded = std::chrono::steady_clock::now();
+
+        for (CommandList* list : lists) {
+            list->execute();
+        }
+        glFinish();
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        if (counter == 1) {
+            std::cout << "Recording: "
+                      << std::chrono::duration<double>(recorded - start).count() * UNIT_FACTOR
+                      << " " UNIT ", replay: "
+                      << std::chrono::duration<double>(end - recorded).count() * UNIT_FACTOR
+                      << " " UNIT << std::endl;
+        }
+
+        result.addFramedata(std::chrono::duration<double>(end - start).count() * UNIT_FACTOR);
+        counter++;
+
+        std::cout << counter << " ";
+
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+    } while (glfwGetKey(window, GLFW_KEY_ESCAPE) != GLFW_PRESS &&
+             glfwWindowShouldClose(window) == 0 && counter < N_FRAMES);
+    std::cout << std::endl;
+
+    for (CommandList* list : lists) {
+        delete list;
+    }
+    GLState::deleteTextures(numTextures, textures);
+    for (ShaderProgram* program : programs) {
+        delete program;
+    }
 
     return result;
 }
@@ -227,6 +1348,143 @@ int main(int argc, char** argv)
         std::cout << implResults.toString(DECIMALS) << std::endl;
         std::cout << "Factor:" << roundedString(avgFac, DECIMALS) << std::endl;
 
+        command = exePath + " instanced " + outFile;
+        std::cout << "Starting instanced..." << std::endl;
+        std::system(command.c_str());
+        BenchmarkStats instancedResults(readStats(outFile.c_str()));
+        std::remove(outFile.c_str());
+
+        std::cout << "Instanced (" UNIT "):" << std::endl;
+        std::cout << instancedResults.toString(DECIMALS) << std::endl;
+
+        command = exePath + " packed " + outFile;
+        std::cout << "Starting packed..." << std::endl;
+        std::system(command.c_str());
+        BenchmarkStats packedResults(readStats(outFile.c_str()));
+        std::remove(outFile.c_str());
+
+        std::cout << "Packed (" UNIT "):" << std::endl;
+        std::cout << packedResults.toString(DECIMALS) << std::endl;
+
+        for (const char* mode : {"plain", "optimized"}) {
+            command = exePath + " indexed " + outFile + " " + mode;
+            std::cout << "Starting indexed (" << mode << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats indexedResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Indexed " << mode << " (" UNIT "):" << std::endl;
+            std::cout << indexedResults.toString(DECIMALS) << std::endl;
+        }
+
+        command = exePath + " streaming " + outFile;
+        std::cout << "Starting streaming buffer..." << std::endl;
+        std::system(command.c_str());
+        BenchmarkStats streamingResults(readStats(outFile.c_str()));
+        std::remove(outFile.c_str());
+
+        std::cout << "Streaming buffer (" UNIT "):" << std::endl;
+        std::cout << streamingResults.toString(DECIMALS) << std::endl;
+
+        for (const char* mode : {"staged", "inplace"}) {
+            command = exePath + " generate " + outFile + " " + mode;
+            std::cout << "Starting per frame generation (" << mode << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats generateResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Per frame generation " << mode << " (" UNIT "):" << std::endl;
+            std::cout << generateResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* percent : {"1", "10", "100"}) {
+            command = exePath + " partial " + outFile + " " + percent;
+            std::cout << "Starting partial update (" << percent << "%)..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats partialResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Partial update " << percent << "% (" UNIT "):" << std::endl;
+            std::cout << partialResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* encoding : {"ascii", "utf8"}) {
+            command = exePath + " layout " + outFile + " " + encoding;
+            std::cout << "Starting text layout (" << encoding << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats layoutResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Text layout " << encoding << " (" UNIT "):" << std::endl;
+            std::cout << layoutResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* path : {"vertex", "instanced"}) {
+            command = exePath + " glyphs " + outFile + " " + path;
+            std::cout << "Starting glyph upload (" << path << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats glyphResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Glyph upload " << path << " (" UNIT "):" << std::endl;
+            std::cout << glyphResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* percent : {"1", "100"}) {
+            command = exePath + " text " + outFile + " " + percent;
+            std::cout << "Starting retained text (" << percent << "% changed)..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats textResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Retained text " << percent << "% changed (" UNIT "):" << std::endl;
+            std::cout << textResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* cache : {"cold", "warm"}) {
+            command = exePath + " programs " + outFile + " " + cache;
+            std::cout << "Starting program creation (" << cache << " cache)..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats programResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Program creation " << cache << " cache (" UNIT "):" << std::endl;
+            std::cout << programResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* mode : {"sequential", "async"}) {
+            command = exePath + " compile " + outFile + " " + mode;
+            std::cout << "Starting program compilation (" << mode << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats compileResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Program compilation " << mode << " (" UNIT "):" << std::endl;
+            std::cout << compileResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* order : {"submitted", "sorted"}) {
+            command = exePath + " queue " + outFile + " " + order;
+            std::cout << "Starting draw submission (" << order << ")..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats queueResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Draw submission " << order << " (" UNIT "):" << std::endl;
+            std::cout << queueResults.toString(DECIMALS) << std::endl;
+        }
+
+        for (const char* threads : {"1", "2", "4", "8"}) {
+            command = exePath + " commands " + outFile + " " + threads;
+            std::cout << "Starting command recording (" << threads << " threads)..." << std::endl;
+            std::system(command.c_str());
+            BenchmarkStats commandResults(readStats(outFile.c_str()));
+            std::remove(outFile.c_str());
+
+            std::cout << "Command recording " << threads << " threads (" UNIT "):" << std::endl;
+            std::cout << commandResults.toString(DECIMALS) << std::endl;
+        }
+
         return 0;
     }
 
@@ -237,6 +1495,65 @@ int main(int argc, char** argv)
     else if (args[1] == "impl") {
         run_benchmark(run_impl, args[2].c_str());
     }
+    else if (args[1] == "instanced") {
+        run_benchmark(run_instanced, args[2].c_str());
+    }
+    else if (args[1] == "packed") {
+        run_benchmark(run_packed, args[2].c_str());
+    }
+    else if (args[1] == "indexed") {
+        bool optimize = args.size() > 3 && args[3] == "optimized";
+        run_benchmark([optimize](GLFWwindow* window) { return run_indexed(window, optimize); },
+            args[2].c_str());
+    }
+    else if (args[1] == "streaming") {
+        run_benchmark(run_streaming, args[2].c_str());
+    }
+    else if (args[1] == "generate") {
+        bool staged = args[3] == "staged";
+        run_benchmark(
+            [staged](GLFWwindow* window) { return run_generate(window, staged); }, args[2].c_str());
+    }
+    else if (args[1] == "partial") {
+        unsigned int percent = std::stoi(args[3]);
+        run_benchmark(
+            [percent](GLFWwindow* window) { return run_partial(window, percent); }, args[2].c_str());
+    }
+    else if (args[1] == "layout") {
+        bool utf8 = args[3] == "utf8";
+        run_benchmark(
+            [utf8](GLFWwindow* window) { return run_layout(window, utf8); }, args[2].c_str());
+    }
+    else if (args[1] == "glyphs") {
+        bool instanced = args[3] == "instanced";
+        run_benchmark([instanced](GLFWwindow* window) { return run_glyphs(window, instanced); },
+            args[2].c_str());
+    }
+    else if (args[1] == "text") {
+        unsigned int percent = std::stoi(args[3]);
+        run_benchmark(
+            [percent](GLFWwindow* window) { return run_text(window, percent); }, args[2].c_str());
+    }
+    else if (args[1] == "programs") {
+        bool warm = args[3] == "warm";
+        run_benchmark(
+            [warm](GLFWwindow* window) { return run_programs(window, warm); }, args[2].c_str());
+    }
+    else if (args[1] == "compile") {
+        bool async = args[3] == "async";
+        run_benchmark(
+            [async](GLFWwindow* window) { return run_compile(window, async); }, args[2].c_str());
+    }
+    else if (args[1] == "queue") {
+        bool sorted = args[3] == "sorted";
+        run_benchmark(
+            [sorted](GLFWwindow* window) { return run_queue(window, sorted); }, args[2].c_str());
+    }
+    else if (args[1] == "commands") {
+        unsigned int threads = std::stoi(args[3]);
+        run_benchmark([threads](GLFWwindow* window) { return run_commands(window, threads); },
+            args[2].c_str());
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <math.h>
 
 #include "buffer.h"
+#include "interleave.h"
+#include "mesh.h"
 #include "render_context.h"
 
 
@@ -71,8 +73,8 @@ class MandelBrot {
 };
 
 
-void getCube(
-    GLfloat x1, GLfloat y1, GLfloat z1, GLfloat x8, GLfloat y8, GLfloat z8, GLfloat* vertices)
+void getCube(GLfloat x1, GLfloat y1, GLfloat z1, GLfloat x8, GLfloat y8, GLfloat z8,
+    VertexView<GLfloat> vertices)
 {
     GLfloat y2 = y1;
     GLfloat y5 = y1;
@@ -106,26 +108,31 @@ void getCube(
     };
     // clang-format on
 
-    std::copy(tmp, tmp + 36 * 3, vertices);
+    for (int i = 0; i < 36; i++) {
+        GLfloat* vertex = vertices[i];
+        vertex[0] = tmp[i * 3];
+        vertex[1] = tmp[i * 3 + 1];
+        vertex[2] = tmp[i * 3 + 2];
+    }
 }
 
 
-void getVertexData(GLfloat* vertices, GLfloat* colors, unsigned int xCubes, unsigned int yCubes,
-    unsigned int screenWidth, unsigned int screenHeight)
+/// @brief Writes cube vertices for precomputed mandelbrot values.
+/// @param pixelData Mandelbrot value for each cube.
+/// @param vertices, colors Views on `xCubes * yCubes * 36` vertices.
+void getVertexData(const float* pixelData, VertexView<GLfloat> vertices, VertexView<GLfloat> colors,
+    unsigned int xCubes, unsigned int yCubes, unsigned int screenWidth, unsigned int screenHeight)
 {
     unsigned int cubeWidth = screenWidth / xCubes;
     unsigned int cubeHeight = screenHeight / yCubes;
 
-    MandelBrot mandel(-2.0, 1.0, -1.0, 1.0, xCubes, yCubes, 255);
-    float* pixel_data = mandel.calculate();
-
     for (int y = 0; y < yCubes; y++) {
         for (int x = 0; x < xCubes; x++) {
-            float pixVal = *(pixel_data + y * xCubes + x);
+            float pixVal = *(pixelData + y * xCubes + x);
 
-            GLfloat* cubeColor = colors + (y * xCubes + x) * 36;
+            VertexView<GLfloat> cubeColor = colors.sub((y * xCubes + x) * 36, 36);
             for (int i = 0; i < 36; i++) {
-                cubeColor[i] = (GLfloat)pixVal;
+                *cubeColor[i] = (GLfloat)pixVal;
             }
 
             double xFac = (double)cubeWidth / screenWidth;
@@ -137,8 +144,46 @@ void getVertexData(GLfloat* vertices, GLfloat* colors, unsigned int xCubes, unsi
             GLfloat y8 = (y + 1) * yFac * 2.0f - 1.0f;
             GLfloat z8 = 1;
 
-            GLfloat* cubeVertices = vertices + (y * yCubes + x) * 36 * 3;
-            getCube(x1, y1, z1, x8, y8, z8, cubeVertices);
+            getCube(x1, y1, z1, x8, y8, z8, vertices.sub((y * yCubes + x) * 36, 36));
+        }
+    }
+}
+
+
+void getVertexData(GLfloat* vertices, GLfloat* colors, unsigned int xCubes, unsigned int yCubes,
+    unsigned int screenWidth, unsigned int screenHeight)
+{
+    MandelBrot mandel(-2.0, 1.0, -1.0, 1.0, xCubes, yCubes, 255);
+    float* pixel_data = mandel.calculate();
+
+    unsigned int numVertex = xCubes * yCubes * 36;
+    getVertexData(pixel_data, VertexView<GLfloat>(vertices, 3 * sizeof(GLfloat), numVertex),
+        VertexView<GLfloat>(colors, sizeof(GLfloat), numVertex), xCubes, yCubes, screenWidth,
+        screenHeight);
+}
+
+
+/// @brief Writes per instance data for drawing a single cube mesh once per mandelbrot value.
+/// @param mesh Receives 36 vertices of cube at origin.
+/// @param offsets Receives 2 floats per cube, position of cube corner.
+/// @param colors Receives 1 float per cube.
+void getInstanceData(GLfloat* mesh, GLfloat* offsets, GLfloat* colors, unsigned int xCubes,
+    unsigned int yCubes, unsigned int screenWidth, unsigned int screenHeight)
+{
+    MandelBrot mandel(-2.0, 1.0, -1.0, 1.0, xCubes, yCubes, 255);
+    float* pixel_data = mandel.calculate();
+
+    double xFac = (double)(screenWidth / xCubes) / screenWidth;
+    double yFac = (double)(screenHeight / yCubes) / screenHeight;
+    getCube(0, 0, 0, xFac * 2.0f, yFac * 2.0f, 1,
+        VertexView<GLfloat>(mesh, 3 * sizeof(GLfloat), 36));
+
+    for (int y = 0; y < yCubes; y++) {
+        for (int x = 0; x < xCubes; x++) {
+            unsigned int idx = y * xCubes + x;
+            colors[idx] = (GLfloat)pixel_data[idx];
+            offsets[idx * 2] = x * xFac * 2.0f - 1.0f;
+            offsets[idx * 2 + 1] = y * yFac * 2.0f - 1.0f;
         }
     }
 }
\ No newline at end of file
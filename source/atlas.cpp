@@ -0,0 +1,213 @@
+#include "atlas.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+
+#include "gl_state.h"
+
+
+SkylinePacker::SkylinePacker(unsigned int width, unsigned int height)
+    : width(width), height(height)
+{
+    skyline.push_back({0, 0, (int)width});
+}
+
+
+bool SkylinePacker::pack(unsigned int width, unsigned int height, unsigned int* x, unsigned int* y)
+{
+    int bestIdx = -1;
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    int bestY = 0;
+
+    for (std::size_t i = 0; i < skyline.size(); i++) {
+        int top = fit(i, width, height);
+        if (top < 0) {
+            continue;
+        }
+
+        // Lowest top edge, ties broken by narrowest node to reduce wasted space
+        if (top + (int)height < bestTop ||
+            (top + (int)height == bestTop && skyline[i].width < bestWidth)) {
+            bestIdx = i;
+            bestTop = top + height;
+            bestWidth = skyline[i].width;
+            bestY = top;
+        }
+    }
+
+    if (bestIdx == -1) {
+        return false;
+    }
+
+    Node node = {skyline[bestIdx].x, bestY + (int)height, (int)width};
+    skyline.insert(skyline.begin() + bestIdx, node);
+
+    // Shrink or remove nodes covered by new node
+    for (std::size_t i = bestIdx + 1; i < skyline.size();) {
+        int overlap = node.x + node.width - skyline[i].x;
+        if (overlap <= 0) {
+            break;
+        }
+
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+        if (skyline[i].width > 0) {
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // Merge neighbours of same height
+    for (std::size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else {
+            i++;
+        }
+    }
+
+    *x = node.x;
+    *y = bestY;
+    return true;
+}
+
+
+int SkylinePacker::fit(std::size_t idx, int width, int height) const
+{
+    if (skyline[idx].x + width > this->width) {
+        return -1;
+    }
+
+    int y = 0;
+    int remaining = width;
+    for (std::size_t i = idx; remaining > 0; i++) {
+        y = std::max(y, skyline[i].y);
+        if (y + height > this->height) {
+            return -1;
+        }
+        remaining -= skyline[i].width;
+    }
+
+    return y;
+}
+
+
+GlyphAtlas::GlyphAtlas(unsigned int pageSize, unsigned int padding)
+    : _pageSize(pageSize), padding(padding), uvs(4, 0.0f)
+{
+}
+
+
+GlyphAtlas::~GlyphAtlas()
+{
+    if (!textures.empty()) {
+        GLState::deleteTextures(textures.size(), textures.data());
+    }
+    if (_uvTexture != 0) {
+        GLState::deleteTextures(1, &_uvTexture);
+        GLState::deleteBuffers(1, &uvBuffer);
+    }
+}
+
+
+AtlasRegion GlyphAtlas::insert(
+    const unsigned char* bitmap, unsigned int width, unsigned int height, unsigned int pitch)
+{
+    if (width == 0 || height == 0) {
+        return {0, 0, 0, 0, 0, 0};
+    }
+    if (width + 2 * padding > _pageSize || height + 2 * padding > _pageSize) {
+        throw std::length_error("Bitmap exceeds glyph atlas page size");
+    }
+
+    unsigned int x;
+    unsigned int y;
+    unsigned int page = 0;
+    while (page < packers.size() &&
+           !packers[page].pack(width + 2 * padding, height + 2 * padding, &x, &y)) {
+        page++;
+    }
+
+    if (page == packers.size()) {
+        addPage();
+        packers[page].pack(width + 2 * padding, height + 2 * padding, &x, &y);
+    }
+
+    AtlasRegion region = {page, (unsigned int)uvs.size() / 4, x + padding, y + padding, width,
+        height};
+
+    float size = _pageSize;
+    uvs.insert(uvs.end(), {region.x / size, region.y / size, (region.x + width) / size,
+        (region.y + height) / size});
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    GLState::bindTexture(GL_TEXTURE_2D, textures[page]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, width, height, GL_RED,
+        GL_UNSIGNED_BYTE, (void*)bitmap);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    return region;
+}
+
+
+GLuint GlyphAtlas::uvTexture()
+{
+    if (_uvTexture == 0) {
+        glGenBuffers(1, &uvBuffer);
+        glGenTextures(1, &_uvTexture);
+    }
+
+    if (uvsUploaded == uvs.size()) {
+        return _uvTexture;
+    }
+
+    GLState::bindBuffer(GL_TEXTURE_BUFFER, uvBuffer);
+    if (uvs.size() > uvCapacity) {
+        // Grow geometrically, regions are added one at a time
+        uvCapacity = std::max(uvs.size(), 2 * uvCapacity);
+        glBufferData(GL_TEXTURE_BUFFER, uvCapacity * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, uvs.size() * sizeof(float), uvs.data());
+
+        GLState::bindTexture(GL_TEXTURE_BUFFER, _uvTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, uvBuffer);
+    }
+    else {
+        glBufferSubData(GL_TEXTURE_BUFFER, uvsUploaded * sizeof(float),
+            (uvs.size() - uvsUploaded) * sizeof(float), uvs.data() + uvsUploaded);
+    }
+
+    uvsUploaded = uvs.size();
+    return _uvTexture;
+}
+
+
+void GlyphAtlas::addPage()
+{
+    GLuint texture;
+    glGenTextures(1, &texture);
+
+    // Cleared, so padding around bitmaps stays empty
+    std::vector<unsigned char> empty(_pageSize * _pageSize, 0);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, _pageSize, _pageSize, 0, GL_RED, GL_UNSIGNED_BYTE,
+        (void*)empty.data());
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+
+    textures.push_back(texture);
+    packers.emplace_back(_pageSize, _pageSize);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <vector>
+
+
+/// @brief Packs rectangles into a fixed size area using the skyline bottom left heuristic.
+class SkylinePacker {
+  public:
+    SkylinePacker(unsigned int width, unsigned int height);
+
+    /// @brief Finds position for a rectangle.
+    /// @param x, y Receive position of lower left corner.
+    /// @return false if rectangle does not fit.
+    bool pack(unsigned int width, unsigned int height, unsigned int* x, unsigned int* y);
+
+  private:
+    struct Node {
+        int x;
+        int y;
+        int width;
+    };
+
+    /// Returns y at which rectangle fits on top of skyline starting at node `idx`, -1 if it
+    /// does not fit.
+    int fit(std::size_t idx, int width, int height) const;
+
+    int width;
+    int height;
+    std::vector<Node> skyline;
+};
+
+
+/// Location of a bitmap inside a glyph atlas, in pixels.
+struct AtlasRegion {
+    unsigned int page;
+    /// Entry of region in UV table, 0 for empty bitmaps.
+    unsigned int index;
+    unsigned int x, y;
+    unsigned int width, height;
+};
+
+
+/// @brief Stores single channel bitmaps in shared textures.
+/// Bitmaps are packed into square pages separated by @p padding empty pixels. A new page is added
+/// whenever a bitmap does not fit into existing pages.
+class GlyphAtlas {
+  public:
+    /// @param pageSize Width and height of each page texture.
+    /// @param padding Number of empty pixels around each bitmap.
+    GlyphAtlas(unsigned int pageSize = 1024, unsigned int padding = 1);
+    ~GlyphAtlas();
+
+    /// @brief Copies bitmap into atlas.
+    /// @param bitmap Rows of @p width bytes, top row first.
+    /// @param pitch Number of bytes between two rows.
+    AtlasRegion insert(
+        const unsigned char* bitmap, unsigned int width, unsigned int height, unsigned int pitch);
+
+    /// @brief Returns buffer texture (GL_RGBA32F) holding (u1, v1, u2, v2) of every region, v1
+    /// being the top edge. Uploads regions added since last call.
+    GLuint uvTexture();
+
+    GLuint texture(unsigned int page) const { return textures[page]; }
+    unsigned int numPages() const { return textures.size(); }
+    unsigned int pageSize() const { return _pageSize; }
+
+  private:
+    void addPage();
+
+    unsigned int _pageSize;
+    unsigned int padding;
+    std::vector<GLuint> textures;
+    std::vector<SkylinePacker> packers;
+    std::vector<float> uvs;    // 4 floats per region
+    std::size_t uvsUploaded = 0;    // In floats
+    std::size_t uvCapacity = 0;    // In floats
+    GLuint uvBuffer = 0;
+    GLuint _uvTexture = 0;
+};
\ No newline at end of file
@@ -5,6 +5,13 @@
 #include <cstring>
 #include <cassert>
 
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "gl_state.h"
+#include "utility.h"
+
 
 VertexBuffer::VertexBuffer(std::size_t size) : _size(size)
 {
@@ -13,30 +20,30 @@ VertexBuffer::VertexBuffer(std::size_t size) : _size(size)
 }
 
 
+VertexBuffer::VertexBuffer() : data(nullptr), _size(0)
+{
+    glGenBuffers(1, &_id);
+}
+
+
 VertexBuffer::~VertexBuffer()
 {
     delete[] data;
+    GLState::deleteBuffers(1, &_id);
 }
 
 
 void VertexBuffer::add(const void* values, std::size_t n, std::size_t vertexSize,
     std::size_t stride, std::size_t offset)
 {
-    assert((n / vertexSize) * vertexSize == n);
-
-    // TODO choose better size
-    std::size_t requiredSize = (n / vertexSize + offset / stride) * stride;
-    if (requiredSize > _size) {
-        resize(requiredSize);
-    }
+    std::uint8_t* dest = reserve(n, vertexSize, stride, offset);
 
     if (stride == 0) {
-            std::memcpy(data + offset, values, n);
+            std::memcpy(dest, values, n);
             return;
     }
 
     const std::uint8_t* src = static_cast<const std::uint8_t*>(values);
-    std::uint8_t* dest = data + offset;
     unsigned int numVertex = n / vertexSize;
 
     for (std::size_t i = 0; i < numVertex; i++) {
@@ -50,11 +57,49 @@ void VertexBuffer::add(const void* values, std::size_t n, std::size_t vertexSize
 }
 
 
+std::uint8_t* VertexBuffer::reserve(std::size_t n, std::size_t vertexSize, std::size_t stride,
+    std::size_t offset)
+{
+    assert((n / vertexSize) * vertexSize == n);
+
+    // TODO choose better size
+    std::size_t requiredSize = (stride == 0) ? offset + n
+                                             : (n / vertexSize + offset / stride) * stride;
+    if (requiredSize > _size) {
+        resize(requiredSize);
+    }
+
+    unsigned int numVertex = n / vertexSize;
+    if (stride == 0) {
+        markDirty(offset, offset + n);
+    }
+    else if (numVertex > 0) {
+        markDirty(offset, offset + (numVertex - 1) * stride + vertexSize);
+    }
+
+    return data + offset;
+}
+
+
 void VertexBuffer::use(GLenum mode)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, _id);
-    glBufferData(GL_ARRAY_BUFFER, _size, static_cast<void*>(data), mode);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (gpuSize == _size && dirty.empty()) {
+        return;
+    }
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, _id);
+    if (gpuSize != _size) {
+        glBufferData(GL_ARRAY_BUFFER, _size, static_cast<void*>(data), mode);
+        gpuSize = _size;
+    }
+    else {
+        for (const range_t& range : dirty) {
+            glBufferSubData(GL_ARRAY_BUFFER, range.first, range.second - range.first,
+                static_cast<void*>(data + range.first));
+        }
+    }
+
+    dirty.clear();
 }
 
 
@@ -66,4 +111,239 @@ void VertexBuffer::resize(std::size_t size)
     this->_size = size;
 
     delete[] old;
+}
+
+
+void VertexBuffer::markDirty(std::size_t begin, std::size_t end)
+{
+    mergeRange(dirty, begin, end);
+}
+
+
+StreamingBuffer::StreamingBuffer(std::size_t size, unsigned int numRegions)
+    : VertexBuffer(), numRegions(numRegions)
+{
+    _size = size;
+    persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+    fences = new GLsync[numRegions];
+    for (unsigned int i = 0; i < numRegions; i++) {
+        fences[i] = nullptr;
+    }
+
+    allocate();
+    map();
+}
+
+
+StreamingBuffer::~StreamingBuffer()
+{
+    release();
+    delete[] fences;
+}
+
+
+void StreamingBuffer::begin()
+{
+    if (!submitted) {  // Current region still receives data
+        return;
+    }
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % numRegions;
+    waitFence(region);
+    map();
+
+    submitted = false;
+}
+
+
+void StreamingBuffer::use(GLenum mode)
+{
+    if (!persistent && data != nullptr) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, _id);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        data = nullptr;
+    }
+
+    dirty.clear();
+    submitted = true;
+}
+
+
+void StreamingBuffer::resize(std::size_t size)
+{
+    for (unsigned int i = 0; i < numRegions; i++) {
+        waitFence(i);
+    }
+
+    GLuint oldId = _id;
+    std::size_t oldOffset = gpuOffset();
+    if (mapped != nullptr || data != nullptr) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, oldId);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    _id = 0;
+    _size = size;
+    mapped = nullptr;
+    data = nullptr;
+    allocate();
+
+    // Mappings are write only, bytes written this frame are copied by the GPU instead of read back
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, oldId);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, _id);
+    for (const range_t& range : dirty) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, oldOffset + range.first,
+            range.first, range.second - range.first);
+    }
+    GLState::deleteBuffers(1, &oldId);
+
+    // Copied bytes may be overwritten through the mapping, which does not synchronize
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    waitFence(region);
+    map();
+}
+
+
+void StreamingBuffer::allocate()
+{
+    if (_id == 0) {
+        glGenBuffers(1, &_id);
+    }
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, _id);
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, _size * numRegions, nullptr, flags);
+        mapped = static_cast<std::uint8_t*>(
+            glMapBufferRange(GL_ARRAY_BUFFER, 0, _size * numRegions, flags));
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, _size * numRegions, nullptr, GL_STREAM_DRAW);
+    }
+
+    region = 0;
+    submitted = false;
+}
+
+
+void StreamingBuffer::release()
+{
+    for (unsigned int i = 0; i < numRegions; i++) {
+        waitFence(i);
+    }
+
+    if (mapped != nullptr || data != nullptr) {
+        GLState::bindBuffer(GL_ARRAY_BUFFER, _id);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+
+    GLState::deleteBuffers(1, &_id);
+    _id = 0;
+    mapped = nullptr;
+    data = nullptr;
+}
+
+
+void StreamingBuffer::map()
+{
+    if (persistent) {
+        data = (mapped == nullptr) ? nullptr : mapped + region * _size;
+    }
+    else {
+        // Fence of region has been waited for, GPU no longer reads from it
+        GLState::bindBuffer(GL_ARRAY_BUFFER, _id);
+        data = static_cast<std::uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, region * _size, _size,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT));
+    }
+
+    if (data == nullptr) {
+        throw std::runtime_error("Could not map streaming buffer");
+    }
+}
+
+
+void StreamingBuffer::waitFence(unsigned int idx)
+{
+    if (fences[idx] == nullptr) {
+        return;
+    }
+
+    GLenum status;
+    do {
+        status = glClientWaitSync(fences[idx], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    } while (status == GL_TIMEOUT_EXPIRED);
+
+    glDeleteSync(fences[idx]);
+    fences[idx] = nullptr;
+
+    if (status == GL_WAIT_FAILED) {
+        throw std::runtime_error("Waiting for streaming buffer fence failed");
+    }
+}
+
+
+IndexBuffer::IndexBuffer()
+{
+    glGenBuffers(1, &_id);
+}
+
+
+IndexBuffer::~IndexBuffer()
+{
+    GLState::deleteBuffers(1, &_id);
+}
+
+
+void IndexBuffer::add(const std::uint32_t* values, std::size_t n, std::size_t offset)
+{
+    if (offset + n > indices.size()) {
+        indices.resize(offset + n);
+    }
+
+    std::memcpy(indices.data() + offset, values, n * sizeof(std::uint32_t));
+
+    for (std::size_t i = 0; i < n; i++) {
+        maxIndex = std::max(maxIndex, values[i]);
+    }
+    modified = true;
+}
+
+
+void IndexBuffer::clear()
+{
+    indices.clear();
+    maxIndex = 0;
+    modified = true;
+}
+
+
+void IndexBuffer::use(GLenum mode)
+{
+    if (!modified) {
+        return;
+    }
+
+    _type = (maxIndex <= UINT16_MAX) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    const void* values = indices.data();
+    std::vector<std::uint16_t> shortIndices;
+    if (_type == GL_UNSIGNED_SHORT) {
+        shortIndices.assign(indices.begin(), indices.end());
+        values = shortIndices.data();
+    }
+
+    // Element array binding is VAO state, copy target leaves currently bound VAO untouched
+    std::size_t size = indices.size() * indexSize();
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, _id);
+    if (size != gpuSize) {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, values, mode);
+        gpuSize = size;
+    }
+    else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, 0, size, values);
+    }
+
+    modified = false;
 }
\ No newline at end of file
@@ -6,12 +6,42 @@
 #include <cstdint>
 
 #include <utility>
+#include <vector>
+
+
+/// @brief Typed view on strided vertex data.
+/// Element `i` points to first value of vertex `i`, consecutive vertices are `stride` bytes apart.
+template<typename T>
+class VertexView {
+  public:
+    VertexView(void* first, std::size_t stride, std::size_t size)
+        : first(static_cast<std::uint8_t*>(first)), _stride(stride), _size(size) {}
+
+    T* operator[](std::size_t i) const { return reinterpret_cast<T*>(first + i * _stride); }
+
+    /// Returns view on vertices [offset, offset + size).
+    VertexView<T> sub(std::size_t offset, std::size_t size) const
+    {
+        return VertexView<T>(first + offset * _stride, _stride, size);
+    }
+
+    std::size_t stride() const { return _stride; }
+    std::size_t size() const { return _size; }
+
+  private:
+    std::uint8_t* first;
+    std::size_t _stride;
+    std::size_t _size;
+};
 
 
 class VertexBuffer {
   public:
+    /// Half open byte range [first, second).
+    using range_t = std::pair<std::size_t, std::size_t>;
+
     VertexBuffer(std::size_t size);
-    ~VertexBuffer();
+    virtual ~VertexBuffer();
 
     /// @brief Inserts data into buffer.
     /// @param values Data to copy.
@@ -22,16 +52,120 @@ class VertexBuffer {
     void add(const void* values, std::size_t n, std::size_t vertexSize,
         std::size_t stride, std::size_t offset);
 
-    /// @brief Copies content to GPU.
-    void use(GLenum mode);
+    /// @brief Reserves space for data to be written in place, parameters as for `add`.
+    /// Reserved bytes are marked as modified.
+    /// @return Pointer to first reserved byte. Invalidated by next call to `add`/`reserve` or
+    /// `begin`.
+    std::uint8_t* reserve(std::size_t n, std::size_t vertexSize, std::size_t stride,
+        std::size_t offset);
+
+    /// @brief Prepares buffer for a new batch of data.
+    virtual void begin() {}
+
+    /// @brief Copies modified content to GPU.
+    /// GPU storage is only (re)allocated if buffer size changed since last call, otherwise only
+    /// modified byte ranges are uploaded.
+    virtual void use(GLenum mode);
 
     GLuint id() const { return _id; }
     std::size_t size() const { return _size; }
+    /// Returns byte offset of buffer content inside GPU buffer `id()`.
+    virtual std::size_t gpuOffset() const { return 0; }
+    /// Returns sorted, non overlapping byte ranges modified since last call to `use`.
+    const std::vector<range_t>& dirtyRanges() const { return dirty; }
   
   protected:
-    void resize(std::size_t size);
+    /// Creates buffer without CPU storage, `data` must be set by derived class.
+    VertexBuffer();
+
+    virtual void resize(std::size_t size);
+    /// @brief Marks bytes [begin, end) as modified. Merges overlapping and adjacent ranges.
+    void markDirty(std::size_t begin, std::size_t end);
 
     std::uint8_t* data;
     std::size_t _size;
     GLuint _id;
+    std::vector<range_t> dirty;
+
+  private:
+    std::size_t gpuSize = 0;
+};
+
+
+/// @brief Vertex buffer writing directly into persistently mapped GPU memory.
+/// Storage is split into multiple regions, each frame data is written into the next region while
+/// the GPU may still read the previous ones. Regions are guarded by fences. Contents are not
+/// preserved between calls to `begin`, all data has to be rewritten every frame.
+class StreamingBuffer : public VertexBuffer {
+  public:
+    /// @param size Size in bytes of a single region.
+    /// @param numRegions Number of regions, e.g. 3 for triple buffering.
+    StreamingBuffer(std::size_t size, unsigned int numRegions = 3);
+    ~StreamingBuffer();
+
+    /// @brief Fences region written last and waits until next region is no longer used by GPU.
+    void begin() override;
+
+    /// @brief Finishes writing of current region.
+    void use(GLenum mode) override;
+
+    std::size_t gpuOffset() const override { return region * _size; }
+
+    /// Returns true if storage is allocated with `glBufferStorage`.
+    bool isPersistent() const { return persistent; }
+
+  protected:
+    void resize(std::size_t size) override;
+
+  private:
+    /// Creates storage for all regions and starts at first region, mapped persistently if
+    /// supported. `map` has to be called afterwards.
+    void allocate();
+    void release();
+    void map();
+    void waitFence(unsigned int idx);
+
+    unsigned int numRegions;
+    unsigned int region = 0;
+    bool persistent;
+    bool submitted = false;
+    std::uint8_t* mapped = nullptr;
+    GLsync* fences;
+};
+
+
+/// @brief Stores vertex indices for indexed drawing.
+/// Indices are uploaded as 16 bit values if all of them fit, otherwise as 32 bit values.
+class IndexBuffer {
+  public:
+    IndexBuffer();
+    ~IndexBuffer();
+
+    /// @brief Inserts indices into buffer.
+    /// @param values Indices to copy.
+    /// @param n Number of indices to copy.
+    /// @param offset Index of first element to overwrite.
+    void add(const std::uint32_t* values, std::size_t n, std::size_t offset);
+
+    /// @brief Removes all indices.
+    void clear();
+
+    /// @brief Copies content to GPU if modified.
+    void use(GLenum mode);
+
+    GLuint id() const { return _id; }
+    /// Returns number of indices.
+    std::size_t size() const { return indices.size(); }
+    /// Returns type of indices on GPU, `GL_UNSIGNED_SHORT` or `GL_UNSIGNED_INT`.
+    GLenum type() const { return _type; }
+    /// Returns number of bytes per index on GPU.
+    std::size_t indexSize() const { return _type == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+  private:
+    std::vector<std::uint32_t> indices;
+    std::uint32_t maxIndex = 0;
+    bool modified = false;
+    std::size_t gpuSize = 0;
+    GLenum _type = GL_UNSIGNED_SHORT;
+    GLuint _id;
 };
\ No newline at end of file
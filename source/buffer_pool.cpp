@@ -0,0 +1,181 @@
+#include "buffer_pool.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+#include "buffer.h"
+
+
+OffsetAllocator::OffsetAllocator(std::size_t capacity) : _capacity(capacity)
+{
+    insertFree(0, capacity);
+}
+
+
+std::size_t OffsetAllocator::allocate(std::size_t size)
+{
+    assert(size > 0);
+
+    std::multimap<std::size_t, std::size_t>::iterator it = freeBySize.lower_bound(size);
+    if (it == freeBySize.end()) {
+        return INVALID;
+    }
+
+    std::size_t offset = it->second;
+    std::size_t rangeSize = it->first;
+    eraseFree(freeByOffset.find(offset));
+
+    if (rangeSize > size) {
+        insertFree(offset + size, rangeSize - size);
+    }
+
+    allocated[offset] = size;
+    _used += size;
+
+    return offset;
+}
+
+
+void OffsetAllocator::free(std::size_t offset)
+{
+    std::map<std::size_t, std::size_t>::iterator it = allocated.find(offset);
+    assert(it != allocated.end());
+
+    std::size_t size = it->second;
+    allocated.erase(it);
+    _used -= size;
+
+    std::map<std::size_t, std::size_t>::iterator next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.begin()) {
+        std::map<std::size_t, std::size_t>::iterator prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            eraseFree(prev);
+        }
+    }
+
+    if (next != freeByOffset.end() && next->first == offset + size) {
+        size += next->second;
+        eraseFree(next);
+    }
+
+    insertFree(offset, size);
+}
+
+
+std::size_t OffsetAllocator::largestFree() const
+{
+    return freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+}
+
+
+void OffsetAllocator::insertFree(std::size_t offset, std::size_t size)
+{
+    freeByOffset[offset] = size;
+    freeBySize.emplace(size, offset);
+}
+
+
+void OffsetAllocator::eraseFree(std::map<std::size_t, std::size_t>::iterator it)
+{
+    auto range = freeBySize.equal_range(it->second);
+    for (std::multimap<std::size_t, std::size_t>::iterator i = range.first; i != range.second;
+         i++) {
+        if (i->second == it->first) {
+            freeBySize.erase(i);
+            break;
+        }
+    }
+
+    freeByOffset.erase(it);
+}
+
+
+BufferPool::BufferPool(std::size_t stride, unsigned int pageVertex, GLenum usage)
+    : stride(stride), pageVertex(pageVertex), usage(usage)
+{
+}
+
+
+BufferPool::~BufferPool()
+{
+    for (VertexBuffer* page : pages) {
+        delete page;
+    }
+}
+
+
+PoolAllocation BufferPool::allocate(unsigned int numVertex)
+{
+    if (numVertex > pageVertex) {
+        throw std::length_error("Allocation exceeds page size of buffer pool");
+    }
+
+    for (unsigned int i = 0; i < allocators.size(); i++) {
+        std::size_t first = allocators[i].allocate(numVertex);
+        if (first != OffsetAllocator::INVALID) {
+            numAllocations++;
+            return {i, (unsigned int)first, numVertex};
+        }
+    }
+
+    pages.push_back(new VertexBuffer(pageVertex * stride));
+    allocators.emplace_back(pageVertex);
+
+    unsigned int page = pages.size() - 1;
+    std::size_t first = allocators[page].allocate(numVertex);
+    numAllocations++;
+
+    return {page, (unsigned int)first, numVertex};
+}
+
+
+void BufferPool::free(const PoolAllocation& allocation)
+{
+    allocators[allocation.page].free(allocation.first);
+    numAllocations--;
+}
+
+
+void BufferPool::addData(const PoolAllocation& allocation, const void* data,
+    unsigned int numVertex, unsigned int vertexOffset)
+{
+    assert(vertexOffset + numVertex <= allocation.count);
+
+    pages[allocation.page]->add(
+        data, numVertex * stride, stride, stride, (allocation.first + vertexOffset) * stride);
+}
+
+
+void BufferPool::use()
+{
+    for (VertexBuffer* page : pages) {
+        page->use(usage);
+    }
+}
+
+
+BufferPool::Stats BufferPool::stats() const
+{
+    Stats result = {};
+    result.numPages = pages.size();
+    result.numAllocations = numAllocations;
+
+    for (const OffsetAllocator& allocator : allocators) {
+        result.capacity += allocator.capacity();
+        result.used += allocator.used();
+        result.numFreeRanges += allocator.numFreeRanges();
+        if (allocator.largestFree() > result.largestFree) {
+            result.largestFree = allocator.largestFree();
+        }
+    }
+
+    std::size_t totalFree = result.capacity - result.used;
+    result.utilisation = result.capacity == 0 ? 0.0 : (double)result.used / result.capacity;
+    result.fragmentation = totalFree == 0 ? 0.0 : 1.0 - (double)result.largestFree / totalFree;
+
+    return result;
+}
\ No newline at end of file
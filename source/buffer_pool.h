@@ -0,0 +1,110 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "buffer.h"
+
+
+/// @brief Best fit allocator of ranges inside a fixed size block.
+/// Free ranges are kept ordered by offset and by size, freed ranges are coalesced with adjacent
+/// free ranges.
+class OffsetAllocator {
+  public:
+    static constexpr std::size_t INVALID = SIZE_MAX;
+
+    OffsetAllocator(std::size_t capacity);
+
+    /// @brief Allocates `size` units.
+    /// @return Offset of allocated range or `INVALID` if no free range is large enough.
+    std::size_t allocate(std::size_t size);
+
+    /// @brief Frees range previously returned by `allocate`.
+    void free(std::size_t offset);
+
+    std::size_t capacity() const { return _capacity; }
+    std::size_t used() const { return _used; }
+    std::size_t largestFree() const;
+    std::size_t numFreeRanges() const { return freeByOffset.size(); }
+
+  private:
+    void insertFree(std::size_t offset, std::size_t size);
+    void eraseFree(std::map<std::size_t, std::size_t>::iterator it);
+
+    std::size_t _capacity;
+    std::size_t _used = 0;
+    std::map<std::size_t, std::size_t> freeByOffset;    // Maps offset to size
+    std::multimap<std::size_t, std::size_t> freeBySize;    // Maps size to offset
+    std::map<std::size_t, std::size_t> allocated;    // Maps offset to size
+};
+
+
+/// Vertex range handed out by `BufferPool`.
+struct PoolAllocation {
+    unsigned int page;
+    /// Index of first vertex inside page buffer, used as base vertex when drawing.
+    unsigned int first;
+    unsigned int count;
+};
+
+
+/// @brief Shares a few large vertex buffers between many small meshes.
+/// All meshes in a pool have the same vertex layout. A VAO bound to a page buffer can draw every
+/// allocation of that page.
+class BufferPool {
+  public:
+    struct Stats {
+        unsigned int numPages;
+        unsigned int numAllocations;
+        std::size_t capacity;    // In vertices
+        std::size_t used;    // In vertices
+        std::size_t largestFree;    // In vertices
+        std::size_t numFreeRanges;
+        /// Fraction of capacity in use.
+        double utilisation;
+        /// 1 - largest free range / total free vertices, 0 if all free vertices are contiguous.
+        double fragmentation;
+    };
+
+    /// @param stride Number of bytes per vertex.
+    /// @param pageVertex Number of vertices per page buffer.
+    /// @param usage Usage hint passed to `VertexBuffer::use`.
+    BufferPool(std::size_t stride, unsigned int pageVertex, GLenum usage = GL_STATIC_DRAW);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /// @brief Allocates range of vertices, adds a new page if no page has enough space.
+    PoolAllocation allocate(unsigned int numVertex);
+
+    /// @brief Returns range to pool.
+    void free(const PoolAllocation& allocation);
+
+    /// @brief Copies interleaved vertex data into allocation.
+    /// @param data `numVertex` vertices, `stride` bytes each.
+    /// @param vertexOffset Index of first vertex to overwrite, relative to allocation.
+    void addData(const PoolAllocation& allocation, const void* data, unsigned int numVertex,
+        unsigned int vertexOffset = 0);
+
+    /// @brief Copies modified data of all pages to GPU.
+    void use();
+
+    /// Returns buffer of page `idx`, to be bound to a VAO.
+    VertexBuffer* page(unsigned int idx) const { return pages[idx]; }
+    unsigned int numPages() const { return pages.size(); }
+
+    Stats stats() const;
+
+  private:
+    std::size_t stride;
+    unsigned int pageVertex;
+    GLenum usage;
+    unsigned int numAllocations = 0;
+    std::vector<VertexBuffer*> pages;
+    std::vector<OffsetAllocator> allocators;
+};
\ No newline at end of file
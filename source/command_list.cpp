@@ -0,0 +1,137 @@
+#include "command_list.h"
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "gl_state.h"
+
+
+CommandList::CommandList(std::size_t commands, std::size_t bytes)
+{
+    this->commands.reserve(commands);
+    this->bytes.reserve(bytes);
+}
+
+
+void CommandList::use(const ShaderProgram* program)
+{
+    Command command;
+    command.type = CommandType::Use;
+    command.use = {program};
+    commands.push_back(command);
+}
+
+
+void CommandList::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+    Command command;
+    command.type = CommandType::BindTexture;
+    command.texture = {unit, target, texture};
+    commands.push_back(command);
+}
+
+
+void CommandList::addData(VAO* vao, const AttributeBinding* binding, const void* data,
+    unsigned int numVertex, unsigned int vertexOffset)
+{
+    std::size_t size = numVertex * binding->valSize * binding->attribute->size;
+
+    Command command;
+    command.type = CommandType::AddData;
+    command.addData = {vao, binding, store(data, size), numVertex, vertexOffset};
+    commands.push_back(command);
+}
+
+
+void CommandList::end(VAO* vao)
+{
+    Command command;
+    command.type = CommandType::End;
+    command.render = {vao, 0, 0, 0};
+    commands.push_back(command);
+}
+
+
+void CommandList::render(VAO* vao, unsigned int offset, unsigned int numVertex)
+{
+    Command command;
+    command.type = CommandType::Render;
+    command.render = {vao, offset, numVertex, 0};
+    commands.push_back(command);
+}
+
+
+void CommandList::renderIndexed(
+    VAO* vao, unsigned int offset, unsigned int numIndex, int baseVertex)
+{
+    Command command;
+    command.type = CommandType::RenderIndexed;
+    command.render = {vao, offset, numIndex, baseVertex};
+    commands.push_back(command);
+}
+
+
+void CommandList::execute() const
+{
+    for (const Command& command : commands) {
+        switch (command.type) {
+            case CommandType::Use:
+                command.use.program->use();
+                break;
+            case CommandType::Uniform:
+                command.uniform.program->writeUniform(command.uniform.slot,
+                    bytes.data() + command.uniform.data, command.uniform.size);
+                break;
+            case CommandType::BindTexture:
+                GLState::bindTexture(
+                    command.texture.unit, command.texture.target, command.texture.texture);
+                break;
+            case CommandType::AddData:
+                command.addData.vao->addData(command.addData.binding,
+                    bytes.data() + command.addData.data, command.addData.numVertex,
+                    command.addData.vertexOffset);
+                break;
+            case CommandType::End:
+                command.render.vao->end();
+                break;
+            case CommandType::Render:
+                command.render.vao->render(command.render.offset, command.render.count);
+                break;
+            case CommandType::RenderIndexed:
+                command.render.vao->renderIndexed(
+                    command.render.offset, command.render.count, command.render.baseVertex);
+                break;
+        }
+    }
+}
+
+
+void CommandList::clear()
+{
+    commands.clear();
+    bytes.clear();
+}
+
+
+std::size_t CommandList::store(const void* data, std::size_t size)
+{
+    std::size_t offset = bytes.size();
+    bytes.resize(offset + size);
+    std::memcpy(bytes.data() + offset, data, size);
+
+    return offset;
+}
+
+
+void CommandList::recordUniform(
+    ShaderProgram* program, std::size_t slot, const void* values, std::size_t size)
+{
+    Command command;
+    command.type = CommandType::Uniform;
+    command.uniform = {program, slot, store(values, size), size};
+    commands.push_back(command);
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_context.h"
+#include "shader.h"
+
+
+/// @brief Recorded sequence of draws, uniform writes, texture binds and vertex data writes.
+/// Recording only copies arguments and never calls GL, so lists can be filled on any thread.
+/// Each list must only be recorded by one thread at a time. `execute` replays commands on the
+/// thread owning the context, replaying lists in a fixed order gives the same GL calls no matter
+/// which thread finished first.
+/// Commands and copied data are stored in two arrays reused by `clear`, so a list recorded every
+/// frame does not allocate once its storage has grown to the size of a frame.
+/// Objects referenced by commands must stay alive until the list is executed.
+class CommandList {
+  public:
+    /// @param commands, bytes Initial capacity for commands and for copied uniform and vertex data.
+    CommandList(std::size_t commands = 1024, std::size_t bytes = 64 * 1024);
+
+    /// @brief Records `program->use()`.
+    void use(const ShaderProgram* program);
+
+    /// @brief Records write of uniform array elements through @p handle.
+    /// @p values are copied, written to the program's value cache on replay.
+    template<typename T>
+    void setUniform(const UniformHandle<T>& handle, const T* values, GLsizei count = 1);
+    template<typename T> void setUniform(const UniformHandle<T>& handle, const T& value)
+    {
+        setUniform(handle, &value, 1);
+    }
+
+    /// @brief Records `GLState::bindTexture(unit, target, texture)`.
+    void bindTexture(GLenum unit, GLenum target, GLuint texture);
+
+    /// @brief Records `vao->addData(binding, data, numVertex, vertexOffset)`.
+    /// Vertex data is copied while recording.
+    void addData(VAO* vao, const AttributeBinding* binding, const void* data,
+        unsigned int numVertex, unsigned int vertexOffset = 0);
+    /// @brief Records `vao->end()`, uploading data written before.
+    void end(VAO* vao);
+
+    /// @brief Records `vao->render(offset, numVertex)`.
+    void render(VAO* vao, unsigned int offset, unsigned int numVertex);
+    /// @brief Records `vao->renderIndexed(offset, numIndex, baseVertex)`.
+    void renderIndexed(VAO* vao, unsigned int offset, unsigned int numIndex, int baseVertex = 0);
+
+    /// @brief Issues recorded commands in recording order. Must be called on context thread.
+    /// List is not modified and can be executed again.
+    void execute() const;
+
+    /// @brief Removes all commands, keeping storage.
+    void clear();
+
+    /// Returns number of recorded commands.
+    std::size_t size() const { return commands.size(); }
+
+  private:
+    enum class CommandType : std::uint8_t {
+        Use,
+        Uniform,
+        BindTexture,
+        AddData,
+        End,
+        Render,
+        RenderIndexed,
+    };
+
+    struct UseCommand {
+        const ShaderProgram* program;
+    };
+
+    struct UniformCommand {
+        ShaderProgram* program;
+        std::size_t slot;
+        std::size_t data;    // Offset into `bytes`
+        std::size_t size;
+    };
+
+    struct TextureCommand {
+        GLenum unit;
+        GLenum target;
+        GLuint texture;
+    };
+
+    struct AddDataCommand {
+        VAO* vao;
+        const AttributeBinding* binding;
+        std::size_t data;    // Offset into `bytes`
+        unsigned int numVertex;
+        unsigned int vertexOffset;
+    };
+
+    struct RenderCommand {
+        VAO* vao;
+        unsigned int offset;
+        unsigned int count;
+        int baseVertex;
+    };
+
+    struct Command {
+        CommandType type;
+        union {
+            UseCommand use;
+            UniformCommand uniform;
+            TextureCommand texture;
+            AddDataCommand addData;
+            RenderCommand render;
+        };
+    };
+
+    /// Copies @p size bytes to end of `bytes`, returns their offset.
+    std::size_t store(const void* data, std::size_t size);
+    void recordUniform(ShaderProgram* program, std::size_t slot, const void* values,
+        std::size_t size);
+
+    std::vector<Command> commands;
+    std::vector<std::uint8_t> bytes;
+};
+
+
+template<typename T>
+inline void CommandList::setUniform(
+    const UniformHandle<T>& handle, const T* values, GLsizei count)
+{
+    recordUniform(handle.program, handle.slot, values, count * sizeof(T));
+}
\ No newline at end of file
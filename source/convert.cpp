@@ -0,0 +1,250 @@
+#include "convert.h"
+
+#include <GL/Glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OGL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+/// Converts `clamp(src * scale, lo, hi)` rounded to nearest to `T`.
+template<typename T>
+void quantize(const float* src, std::size_t n, T* dest, float scale, float lo, float hi)
+{
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    if constexpr (sizeof(T) <= 2) {
+        const __m128 vScale = _mm_set1_ps(scale);
+        const __m128 vLo = _mm_set1_ps(lo);
+        const __m128 vHi = _mm_set1_ps(hi);
+        auto load = [&](std::size_t j) {
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(src + j), vScale);
+            return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(v, vLo), vHi));
+        };
+
+        for (; i + 16 <= n; i += 16) {
+            __m128i a = load(i);
+            __m128i b = load(i + 4);
+            __m128i c = load(i + 8);
+            __m128i d = load(i + 12);
+
+            if constexpr (std::is_same<T, std::int8_t>::value) {
+                __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), packed);
+            }
+            else if constexpr (std::is_same<T, std::uint8_t>::value) {
+                __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), packed);
+            }
+            else if constexpr (std::is_same<T, std::int16_t>::value) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packs_epi32(a, b));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8), _mm_packs_epi32(c, d));
+            }
+            else {
+                // No unsigned 32 -> 16 bit pack in SSE2, shift into signed range and back
+                const __m128i bias32 = _mm_set1_epi32(32768);
+                const __m128i bias16 = _mm_set1_epi16(-32768);
+                __m128i lo16 = _mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32));
+                __m128i hi16 = _mm_packs_epi32(_mm_sub_epi32(c, bias32), _mm_sub_epi32(d, bias32));
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dest + i), _mm_xor_si128(lo16, bias16));
+                _mm_storeu_si128(
+                    reinterpret_cast<__m128i*>(dest + i + 8), _mm_xor_si128(hi16, bias16));
+            }
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        dest[i] = static_cast<T>(std::nearbyint(std::clamp(src[i] * scale, lo, hi)));
+    }
+}
+
+
+/// Quantises to integer type `T`, normalized values map [-1, 1] or [0, 1] to full range.
+template<typename T>
+void quantize(const float* src, std::size_t n, T* dest, GLboolean normalized)
+{
+    constexpr bool isSigned = std::is_signed<T>::value;
+
+    // 32 bit limits are not representable as float, use largest floats inside integer range
+    float max = (sizeof(T) == 4) ? (isSigned ? 2147483520.0f : 4294967040.0f)
+                                 : (float)std::numeric_limits<T>::max();
+    float min = isSigned ? (float)std::numeric_limits<T>::min() : 0.0f;
+
+    if (normalized) {
+        quantize(src, n, dest, max, isSigned ? -max : 0.0f, max);
+    }
+    else {
+        quantize(src, n, dest, 1.0f, min, max);
+    }
+}
+
+
+void halfScalar(const float* src, std::size_t n, std::uint16_t* dest)
+{
+    for (std::size_t i = 0; i < n; i++) {
+        dest[i] = floatToHalf(src[i]);
+    }
+}
+
+
+#ifdef OGL_X86_KERNELS
+__attribute__((target("f16c"))) void halfF16c(const float* src, std::size_t n, std::uint16_t* dest)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i half = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i), half);
+    }
+
+    halfScalar(src + i, n - i, dest + i);
+}
+#endif
+
+
+void toHalf(const float* src, std::size_t n, std::uint16_t* dest)
+{
+#ifdef OGL_X86_KERNELS
+    static const bool hasF16c = __builtin_cpu_supports("f16c");
+    if (hasF16c) {
+        halfF16c(src, n, dest);
+        return;
+    }
+#endif
+
+    halfScalar(src, n, dest);
+}
+
+
+/// Packs 4 components into 10/10/10/2 bits, x in lowest bits.
+template<bool Signed>
+void pack2101010(const float* src, std::size_t numVertex, std::uint32_t* dest, GLboolean normalized)
+{
+    const float max[4] = {Signed ? 511.0f : 1023.0f, Signed ? 511.0f : 1023.0f,
+        Signed ? 511.0f : 1023.0f, Signed ? 1.0f : 3.0f};
+    const int shift[4] = {0, 10, 20, 30};
+    const std::uint32_t mask[4] = {0x3FF, 0x3FF, 0x3FF, 0x3};
+
+    for (std::size_t v = 0; v < numVertex; v++) {
+        std::uint32_t packed = 0;
+        for (int c = 0; c < 4; c++) {
+            float scale = normalized ? max[c] : 1.0f;
+            float lo = Signed ? -max[c] - (normalized ? 0.0f : 1.0f) : 0.0f;
+            std::int32_t value =
+                (std::int32_t)std::nearbyint(std::clamp(src[v * 4 + c] * scale, lo, max[c]));
+            packed |= ((std::uint32_t)value & mask[c]) << shift[c];
+        }
+        dest[v] = packed;
+    }
+}
+
+}    // namespace
+
+
+std::uint16_t floatToHalf(float value)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t abs = bits & 0x7FFFFFFF;
+
+    if (abs >= 0x7F800000) {    // Inf or NaN
+        return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 : 0);
+    }
+    if (abs >= 0x477FF000) {    // Rounds to infinity
+        return sign | 0x7C00;
+    }
+    if (abs < 0x33000000) {    // Rounds to zero
+        return sign;
+    }
+
+    std::uint32_t half;
+    std::uint32_t rest;
+    std::uint32_t halfway;
+    if (abs < 0x38800000) {    // Subnormal half
+        std::uint32_t shift = 126 - (abs >> 23);
+        std::uint32_t mantissa = (abs & 0x7FFFFF) | 0x800000;
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else {
+        half = (abs - 0x38000000) >> 13;    // Rebias exponent from 127 to 15
+        rest = abs & 0x1FFF;
+        halfway = 0x1000;
+    }
+
+    if (rest > halfway || (rest == halfway && (half & 1))) {
+        half++;
+    }
+
+    return sign | half;
+}
+
+
+std::size_t packedSize(GLenum type, unsigned int size)
+{
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: return size;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT: return 2 * size;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT: return 4 * size;
+        case GL_DOUBLE: return 8 * size;
+        case GL_INT_2_10_10_10_REV:
+        case GL_UNSIGNED_INT_2_10_10_10_REV: return 4;
+    }
+
+    throw std::invalid_argument("Unsupported vertex attribute type");
+}
+
+
+void packFloats(const float* src, std::size_t numVertex, unsigned int size, GLenum type,
+    GLboolean normalized, void* dest)
+{
+    std::size_t n = numVertex * size;
+
+    switch (type) {
+        case GL_FLOAT: std::memcpy(dest, src, n * sizeof(float)); break;
+        case GL_HALF_FLOAT: toHalf(src, n, static_cast<std::uint16_t*>(dest)); break;
+        case GL_BYTE: quantize(src, n, static_cast<std::int8_t*>(dest), normalized); break;
+        case GL_UNSIGNED_BYTE: quantize(src, n, static_cast<std::uint8_t*>(dest), normalized); break;
+        case GL_SHORT: quantize(src, n, static_cast<std::int16_t*>(dest), normalized); break;
+        case GL_UNSIGNED_SHORT:
+            quantize(src, n, static_cast<std::uint16_t*>(dest), normalized);
+            break;
+        case GL_INT: quantize(src, n, static_cast<std::int32_t*>(dest), normalized); break;
+        case GL_UNSIGNED_INT: quantize(src, n, static_cast<std::uint32_t*>(dest), normalized); break;
+        case GL_INT_2_10_10_10_REV:
+            if (size != 4) {
+                throw std::invalid_argument("GL_INT_2_10_10_10_REV requires 4 components");
+            }
+            pack2101010<true>(src, numVertex, static_cast<std::uint32_t*>(dest), normalized);
+            break;
+        case GL_UNSIGNED_INT_2_10_10_10_REV:
+            if (size != 4) {
+                throw std::invalid_argument("GL_UNSIGNED_INT_2_10_10_10_REV requires 4 components");
+            }
+            pack2101010<false>(src, numVertex, static_cast<std::uint32_t*>(dest), normalized);
+            break;
+        default: throw std::invalid_argument("Unsupported vertex attribute type");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// @brief Returns number of bytes per vertex of an attribute stored as @p type.
+/// @param size Number of components per vertex, must be 4 for packed types like
+/// `GL_INT_2_10_10_10_REV`.
+std::size_t packedSize(GLenum type, unsigned int size);
+
+/// @brief Converts float values into storage format of a vertex attribute.
+/// Supported types are `GL_FLOAT`, `GL_HALF_FLOAT`, 8/16/32 bit integers and
+/// `GL_(UNSIGNED_)INT_2_10_10_10_REV`. With @p normalized integers are quantised from [-1, 1]
+/// (signed) or [0, 1] (unsigned), otherwise values are rounded and clamped to the integer range.
+/// @param src `numVertex * size` float values.
+/// @param dest Receives `numVertex * packedSize(type, size)` bytes.
+void packFloats(const float* src, std::size_t numVertex, unsigned int size, GLenum type,
+    GLboolean normalized, void* dest);
+
+/// @brief Converts a float to IEEE 754 half precision, rounding to nearest even.
+std::uint16_t floatToHalf(float value);
\ No newline at end of file
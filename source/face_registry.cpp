@@ -0,0 +1,192 @@
+#include "face_registry.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+std::mutex FaceRegistry::mutex;
+FT_Library FaceRegistry::library = nullptr;
+std::map<FaceRegistry::Key, FT_Face> FaceRegistry::faces;
+std::map<FT_Face, FaceRegistry::Entry> FaceRegistry::entries;
+std::map<std::string, FaceRegistry::MappedFile> FaceRegistry::files;
+
+
+FT_Face FaceRegistry::acquire(const std::string& path, FT_Long index, unsigned int pixelSize)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Key key = std::make_tuple(path, index, pixelSize);
+    std::map<Key, FT_Face>::iterator it = faces.find(key);
+    if (it != faces.end()) {
+        entries[it->second].refs++;
+        return it->second;
+    }
+
+    if (!files.contains(path)) {
+        MappedFile file = mapFile(path);
+        file.refs = 0;
+        files[path] = file;
+    }
+    MappedFile& file = files[path];
+
+    // Undoes setup of this call if no face could be created
+    auto discard = [&]() {
+        if (file.refs == 0) {
+            unmapFile(file);
+            files.erase(path);
+        }
+        if (faces.empty() && library != nullptr) {
+            FT_Done_FreeType(library);
+            library = nullptr;
+        }
+    };
+
+    if (library == nullptr && FT_Init_FreeType(&library)) {
+        library = nullptr;
+        discard();
+        throw std::runtime_error("Could not load FreeType2");
+    }
+
+    FT_Face face;
+    if (FT_New_Memory_Face(library, file.data, file.size, index, &face)) {
+        discard();
+        throw std::runtime_error("Could not load face " + path);
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
+
+    file.refs++;
+    faces[key] = face;
+    entries[face] = {key, 1};
+
+    return face;
+}
+
+
+void FaceRegistry::release(FT_Face face)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::map<FT_Face, Entry>::iterator it = entries.find(face);
+    if (it == entries.end()) {
+        throw std::invalid_argument("Face was not acquired from registry");
+    }
+
+    if (--it->second.refs > 0) {
+        return;
+    }
+
+    const std::string& path = std::get<0>(it->second.key);
+    FT_Done_Face(face);
+
+    // Memory of face must stay valid until FT_Done_Face
+    MappedFile& file = files[path];
+    if (--file.refs == 0) {
+        unmapFile(file);
+        files.erase(path);
+    }
+
+    faces.erase(it->second.key);
+    entries.erase(it);
+
+    if (faces.empty()) {
+        FT_Done_FreeType(library);
+        library = nullptr;
+    }
+}
+
+
+std::size_t FaceRegistry::numFaces()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return faces.size();
+}
+
+
+std::size_t FaceRegistry::numFiles()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return files.size();
+}
+
+
+#ifdef _WIN32
+FaceRegistry::MappedFile FaceRegistry::mapFile(const std::string& path)
+{
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open font file " + path);
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* data =
+        mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    // View keeps mapping alive
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+
+    if (data == nullptr) {
+        throw std::runtime_error("Could not map font file " + path);
+    }
+
+    return {static_cast<const FT_Byte*>(data), (std::size_t)size.QuadPart, 0};
+}
+
+
+void FaceRegistry::unmapFile(const MappedFile& file)
+{
+    UnmapViewOfFile(file.data);
+}
+#else
+FaceRegistry::MappedFile FaceRegistry::mapFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Could not open font file " + path);
+    }
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    // Mapping stays valid after closing descriptor
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Could not map font file " + path);
+    }
+
+    return {static_cast<const FT_Byte*>(data), (std::size_t)info.st_size, 0};
+}
+
+
+void FaceRegistry::unmapFile(const MappedFile& file)
+{
+    munmap(const_cast<FT_Byte*>(file.data), file.size);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+
+/// @brief Process wide, reference counted registry of FreeType faces.
+/// Font files are memory mapped once and faces are created from memory. Faces with same path,
+/// face index and pixel size are shared. Faces, mappings and the FreeType library are freed when
+/// their last user releases them.
+class FaceRegistry {
+  public:
+    /// @brief Returns face with given pixel size, opening it on first use.
+    /// Every call must be paired with a call to `release`.
+    static FT_Face acquire(const std::string& path, FT_Long index, unsigned int pixelSize);
+
+    /// @brief Releases face returned by `acquire`.
+    static void release(FT_Face face);
+
+    /// @brief Returns number of distinct faces currently open.
+    static std::size_t numFaces();
+
+    /// @brief Returns number of font files currently mapped.
+    static std::size_t numFiles();
+
+  private:
+    using Key = std::tuple<std::string, FT_Long, unsigned int>;
+
+    struct MappedFile {
+        const FT_Byte* data;
+        std::size_t size;
+        unsigned int refs;
+    };
+
+    struct Entry {
+        Key key;
+        unsigned int refs;
+    };
+
+    static MappedFile mapFile(const std::string& path);
+    static void unmapFile(const MappedFile& file);
+
+    static std::mutex mutex;
+    static FT_Library library;
+    static std::map<Key, FT_Face> faces;
+    static std::map<FT_Face, Entry> entries;
+    static std::map<std::string, MappedFile> files;
+};
\ No newline at end of file
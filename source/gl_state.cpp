@@ -0,0 +1,224 @@
+#include "gl_state.h"
+
+#include <GL/Glew.h>
+
+#include <map>
+#include <optional>
+#include <utility>
+
+
+GLStateCounters GLState::_counters = {0, 0};
+
+std::optional<GLuint> GLState::program;
+std::optional<GLuint> GLState::vertexArray;
+std::map<GLenum, GLuint> GLState::buffers;
+std::map<std::pair<GLenum, GLuint>, GLuint> GLState::indexedBuffers;
+std::optional<GLenum> GLState::unit;
+std::map<std::pair<GLenum, GLenum>, GLuint> GLState::textures;
+std::map<GLenum, bool> GLState::capabilities;
+std::optional<std::pair<GLenum, GLenum>> GLState::blend;
+std::optional<GLenum> GLState::depth;
+std::optional<GLenum> GLState::cull;
+
+
+template<typename T> bool GLState::change(std::optional<T>& cached, const T& value)
+{
+    if (cached == value) {
+        _counters.skipped++;
+        return false;
+    }
+
+    cached = value;
+    _counters.issued++;
+    return true;
+}
+
+
+template<typename K, typename T>
+bool GLState::change(std::map<K, T>& cached, const K& key, const T& value)
+{
+    typename std::map<K, T>::iterator it = cached.find(key);
+    if (it != cached.end() && it->second == value) {
+        _counters.skipped++;
+        return false;
+    }
+
+    cached[key] = value;
+    _counters.issued++;
+    return true;
+}
+
+
+void GLState::useProgram(GLuint program)
+{
+    if (change(GLState::program, program)) {
+        glUseProgram(program);
+    }
+}
+
+
+void GLState::bindVertexArray(GLuint vertexArray)
+{
+    if (change(GLState::vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+
+void GLState::bindBuffer(GLenum target, GLuint buffer)
+{
+    // Belongs to bound VAO, would have to be tracked per VAO
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        _counters.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (change(buffers, target, buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+
+void GLState::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    if (change(indexedBuffers, std::make_pair(target, index), buffer)) {
+        glBindBufferBase(target, index, buffer);
+        buffers[target] = buffer;
+    }
+}
+
+
+void GLState::activeTexture(GLenum unit)
+{
+    if (change(GLState::unit, unit)) {
+        glActiveTexture(unit);
+    }
+}
+
+
+void GLState::bindTexture(GLenum target, GLuint texture)
+{
+    // Unit is unknown after invalidate
+    if (!unit.has_value()) {
+        activeTexture(GL_TEXTURE0);
+    }
+
+    if (change(textures, std::make_pair(*unit, target), texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+
+void GLState::bindTexture(GLenum unit, GLenum target, GLuint texture)
+{
+    std::map<std::pair<GLenum, GLenum>, GLuint>::iterator it =
+        textures.find(std::make_pair(unit, target));
+    if (it != textures.end() && it->second == texture) {
+        _counters.skipped++;
+        return;
+    }
+
+    activeTexture(unit);
+    bindTexture(target, texture);
+}
+
+
+void GLState::enable(GLenum capability)
+{
+    if (change(capabilities, capability, true)) {
+        glEnable(capability);
+    }
+}
+
+
+void GLState::disable(GLenum capability)
+{
+    if (change(capabilities, capability, false)) {
+        glDisable(capability);
+    }
+}
+
+
+void GLState::blendFunc(GLenum source, GLenum destination)
+{
+    if (change(blend, std::make_pair(source, destination))) {
+        glBlendFunc(source, destination);
+    }
+}
+
+
+void GLState::depthFunc(GLenum func)
+{
+    if (change(depth, func)) {
+        glDepthFunc(func);
+    }
+}
+
+
+void GLState::cullFace(GLenum mode)
+{
+    if (change(cull, mode)) {
+        glCullFace(mode);
+    }
+}
+
+
+void GLState::deleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; i++) {
+        for (std::map<GLenum, GLuint>::value_type& binding : GLState::buffers) {
+            if (binding.second == buffers[i]) {
+                binding.second = 0;
+            }
+        }
+        for (std::map<std::pair<GLenum, GLuint>, GLuint>::value_type& binding : indexedBuffers) {
+            if (binding.second == buffers[i]) {
+                binding.second = 0;
+            }
+        }
+    }
+
+    glDeleteBuffers(n, buffers);
+}
+
+
+void GLState::deleteTextures(GLsizei n, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; i++) {
+        for (std::map<std::pair<GLenum, GLenum>, GLuint>::value_type& binding : GLState::textures) {
+            if (binding.second == textures[i]) {
+                binding.second = 0;
+            }
+        }
+    }
+
+    glDeleteTextures(n, textures);
+}
+
+
+void GLState::deleteVertexArrays(GLsizei n, const GLuint* vertexArrays)
+{
+    for (GLsizei i = 0; i < n; i++) {
+        if (vertexArray == vertexArrays[i]) {
+            vertexArray = 0;
+        }
+    }
+
+    glDeleteVertexArrays(n, vertexArrays);
+}
+
+
+void GLState::invalidate()
+{
+    program.reset();
+    vertexArray.reset();
+    buffers.clear();
+    indexedBuffers.clear();
+    unit.reset();
+    textures.clear();
+    capabilities.clear();
+    blend.reset();
+    depth.reset();
+    cull.reset();
+}
\ No newline at end of file
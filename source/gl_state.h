@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <utility>
+
+
+/// Number of state changing calls passed to GL and dropped as redundant.
+struct GLStateCounters {
+    std::size_t issued;
+    std::size_t skipped;
+};
+
+
+/// @brief Cache of GL binding and render state of the current context.
+/// Calls which would not change state are skipped. State starts unknown, so the first call of
+/// each kind is always issued. Code changing state without going through this class must call
+/// `invalidate` afterwards, otherwise later calls may be skipped wrongly.
+/// The element array buffer binding is part of VAO state and is never cached.
+class GLState {
+  public:
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vertexArray);
+    static void bindBuffer(GLenum target, GLuint buffer);
+    /// @brief Binds @p buffer to indexed binding point, which also binds it to @p target.
+    static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    /// @param unit e.g. `GL_TEXTURE0`.
+    static void activeTexture(GLenum unit);
+    /// @brief Binds @p texture to active texture unit.
+    static void bindTexture(GLenum target, GLuint texture);
+    /// @brief Binds @p texture to @p unit, only switching active unit if binding changes.
+    static void bindTexture(GLenum unit, GLenum target, GLuint texture);
+
+    static void enable(GLenum capability);
+    static void disable(GLenum capability);
+    static void blendFunc(GLenum source, GLenum destination);
+    static void depthFunc(GLenum func);
+    static void cullFace(GLenum mode);
+
+    /// @brief Deletes objects and drops them from cache, as GL unbinds deleted objects.
+    static void deleteBuffers(GLsizei n, const GLuint* buffers);
+    static void deleteTextures(GLsizei n, const GLuint* textures);
+    static void deleteVertexArrays(GLsizei n, const GLuint* vertexArrays);
+
+    /// @brief Forgets all cached state, e.g. after calling GL directly.
+    static void invalidate();
+
+    static GLStateCounters counters() { return _counters; }
+    static void resetCounters() { _counters = {0, 0}; }
+
+  private:
+    /// Stores @p value in @p cached, returns whether call changing state has to be issued.
+    template<typename T> static bool change(std::optional<T>& cached, const T& value);
+    template<typename K, typename T>
+    static bool change(std::map<K, T>& cached, const K& key, const T& value);
+
+    static GLStateCounters _counters;
+
+    static std::optional<GLuint> program;
+    static std::optional<GLuint> vertexArray;
+    static std::map<GLenum, GLuint> buffers;
+    static std::map<std::pair<GLenum, GLuint>, GLuint> indexedBuffers;    // (target, index)
+    static std::optional<GLenum> unit;
+    static std::map<std::pair<GLenum, GLenum>, GLuint> textures;    // (unit, target)
+    static std::map<GLenum, bool> capabilities;
+    static std::optional<std::pair<GLenum, GLenum>> blend;
+    static std::optional<GLenum> depth;
+    static std::optional<GLenum> cull;
+};
\ No newline at end of file
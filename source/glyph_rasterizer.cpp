@@ -0,0 +1,183 @@
+#include "glyph_rasterizer.h"
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+void rasterizeGlyph(FT_Face face, char32_t c, GlyphMode mode)
+{
+    FT_Int32 flags = mode == GlyphMode::SDF ? FT_LOAD_DEFAULT : FT_LOAD_RENDER;
+    if (FT_Load_Char(face, c, flags)) {
+        throw std::runtime_error("Could not load char U+" + std::to_string((unsigned long)c));
+    }
+
+    // Outlines without contours (e.g. whitespace) have no distance field
+    if (mode == GlyphMode::SDF && face->glyph->outline.n_contours > 0 &&
+        FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF)) {
+        throw std::runtime_error(
+            "Could not render distance field of char U+" + std::to_string((unsigned long)c));
+    }
+}
+
+
+void copyRows(const FT_Bitmap* bitmap, std::vector<unsigned char>* pixels)
+{
+    // Pitch is added to go one row down, buffer starts with bottom row if it is negative
+    std::ptrdiff_t pitch = bitmap->pitch;
+    const unsigned char* top = bitmap->buffer;
+    if (pitch < 0 && bitmap->rows > 0) {
+        top -= (std::ptrdiff_t)(bitmap->rows - 1) * pitch;
+    }
+
+    pixels->resize((std::size_t)bitmap->width * bitmap->rows);
+    for (unsigned int row = 0; row < bitmap->rows; row++) {
+        std::memcpy(pixels->data() + (std::size_t)row * bitmap->width,
+            top + (std::ptrdiff_t)row * pitch, bitmap->width);
+    }
+}
+
+
+GlyphRasterizer::GlyphRasterizer(const std::string& path, FT_Long index, unsigned int pixelSize,
+    GlyphMode mode, unsigned int numThreads)
+    : mode(mode)
+{
+    for (unsigned int i = 0; i < numThreads; i++) {
+        FT_Library library;
+        if (FT_Init_FreeType(&library)) {
+            release();
+            throw std::runtime_error("Could not load FreeType2");
+        }
+        libraries.push_back(library);
+
+        FT_Face face;
+        if (FT_New_Face(library, path.c_str(), index, &face)) {
+            release();
+            throw std::runtime_error("Could not load face " + path);
+        }
+        FT_Set_Pixel_Sizes(face, 0, pixelSize);
+        faces.push_back(face);
+    }
+
+    for (FT_Face face : faces) {
+        threads.emplace_back(&GlyphRasterizer::work, this, face);
+    }
+}
+
+
+GlyphRasterizer::~GlyphRasterizer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    requested.notify_all();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    release();
+}
+
+
+void GlyphRasterizer::request(char32_t c)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pending.insert(c).second) {
+            return;
+        }
+        queue.push_back(c);
+    }
+    requested.notify_one();
+}
+
+
+std::size_t GlyphRasterizer::collect(std::vector<GlyphBitmap>* glyphs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::size_t n = finished.size();
+    for (GlyphBitmap& glyph : finished) {
+        pending.erase(glyph.code);
+        glyphs->push_back(std::move(glyph));
+    }
+    finished.clear();
+
+    return n;
+}
+
+
+bool GlyphRasterizer::waitUntil(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return finishedOne.wait_until(lock, deadline, [this]() { return !finished.empty(); });
+}
+
+
+std::size_t GlyphRasterizer::numPending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+
+void GlyphRasterizer::work(FT_Face face)
+{
+    while (true) {
+        char32_t c;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            requested.wait(lock, [this]() { return stop || !queue.empty(); });
+            if (stop) {
+                return;
+            }
+
+            c = queue.front();
+            queue.pop_front();
+        }
+
+        GlyphBitmap glyph = {c, {}, 0, 0, 0, 0, 0};
+        try {
+            rasterizeGlyph(face, c, mode);
+
+            const FT_Bitmap* bitmap = &face->glyph->bitmap;
+            glyph.width = bitmap->width;
+            glyph.height = bitmap->rows;
+            glyph.bearingX = face->glyph->bitmap_left;
+            glyph.bearingY = face->glyph->bitmap_top;
+            glyph.advanceX = face->glyph->advance.x >> 6;
+
+            copyRows(bitmap, &glyph.pixels);
+        }
+        catch (const std::runtime_error&) {
+            // Returned empty, so render thread does not request it again
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(std::move(glyph));
+        }
+        finishedOne.notify_all();
+    }
+}
+
+
+void GlyphRasterizer::release()
+{
+    // Faces are released together with their library
+    for (FT_Library library : libraries) {
+        FT_Done_FreeType(library);
+    }
+    libraries.clear();
+    faces.clear();
+}
\ No newline at end of file
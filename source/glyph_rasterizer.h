@@ -0,0 +1,90 @@
+#pragma once
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+
+/// @brief How glyph bitmaps are stored in the atlas.
+/// `Bitmap` stores coverage and blurs or aliases when scaled away from its raster size. `SDF`
+/// stores signed distance to the glyph outline (128 on outline, larger inside), rendered with a
+/// distance field shader it stays sharp at any scale.
+enum class GlyphMode {
+    Bitmap,
+    SDF
+};
+
+
+/// CPU side copy of a rasterised glyph.
+struct GlyphBitmap {
+    char32_t code;
+    /// Rows of `width` bytes, top row first.
+    std::vector<unsigned char> pixels;
+    unsigned int width, height;
+    int bearingX, bearingY;
+    long int advanceX;
+};
+
+
+/// @brief Renders glyph of code point `c` into `face->glyph`.
+/// @throws std::runtime_error if glyph can not be loaded or rendered.
+void rasterizeGlyph(FT_Face face, char32_t c, GlyphMode mode);
+
+/// @brief Copies rows of @p bitmap into @p pixels tightly packed, top row first.
+/// Handles padded rows and bitmaps stored bottom up (negative pitch).
+void copyRows(const FT_Bitmap* bitmap, std::vector<unsigned char>* pixels);
+
+
+/// @brief Rasterises glyphs on worker threads.
+/// Each worker opens its own face, as faces must not be used by several threads at once. Results
+/// are CPU side bitmaps, uploading them is left to the thread owning the GL context.
+class GlyphRasterizer {
+  public:
+    GlyphRasterizer(const std::string& path, FT_Long index, unsigned int pixelSize,
+        GlyphMode mode, unsigned int numThreads);
+    ~GlyphRasterizer();
+
+    GlyphRasterizer(const GlyphRasterizer&) = delete;
+    GlyphRasterizer& operator=(const GlyphRasterizer&) = delete;
+
+    /// @brief Queues glyph of code point `c`, ignored if already queued or in progress.
+    void request(char32_t c);
+
+    /// @brief Moves finished glyphs into `glyphs`.
+    /// Glyphs which failed to load are returned without bitmap and advance.
+    /// @return Number of glyphs moved.
+    std::size_t collect(std::vector<GlyphBitmap>* glyphs);
+
+    /// @brief Blocks until a glyph is finished or `deadline` passed.
+    /// @return false if no glyph finished before deadline.
+    bool waitUntil(std::chrono::steady_clock::time_point deadline);
+
+    /// @brief Returns number of glyphs queued, in progress or not yet collected.
+    std::size_t numPending() const;
+
+  private:
+    void work(FT_Face face);
+    void release();
+
+    GlyphMode mode;
+    std::vector<FT_Library> libraries;
+    std::vector<FT_Face> faces;
+    std::vector<std::thread> threads;
+
+    mutable std::mutex mutex;
+    std::condition_variable requested;
+    std::condition_variable finishedOne;
+    std::deque<char32_t> queue;
+    std::unordered_set<char32_t> pending;
+    std::vector<GlyphBitmap> finished;
+    bool stop = false;
+};
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "interleave.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OGL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+using scatter_t = void (*)(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count);
+using stream_copy_t = void (*)(std::uint8_t* dest, const std::uint8_t* src, std::size_t n);
+
+struct Kernels {
+    const char* name;
+    scatter_t scatter[4];    // Indexed by vertexSize / 4 - 1
+    stream_copy_t streamCopy;
+};
+
+// Bytes of destination written per block, should fit into L1 cache
+constexpr std::size_t BLOCK_SIZE = 16 * 1024;
+
+
+template<std::size_t N>
+void scatterScalar(std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        std::memcpy(dest, src, N);
+        dest += stride;
+        src += N;
+    }
+}
+
+
+void scatterGeneric(std::uint8_t* dest, std::size_t stride, const std::uint8_t* src,
+    std::size_t count, std::size_t n)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        std::memcpy(dest, src, n);
+        dest += stride;
+        src += n;
+    }
+}
+
+
+void streamCopyScalar(std::uint8_t* dest, const std::uint8_t* src, std::size_t n)
+{
+    std::memcpy(dest, src, n);
+}
+
+
+#ifdef OGL_X86_KERNELS
+
+__attribute__((target("sse2"))) void scatter4Sse2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        for (int j = 0; j < 4; j++) {
+            std::int32_t value = _mm_cvtsi128_si32(v);
+            std::memcpy(dest, &value, 4);
+            v = _mm_srli_si128(v, 4);
+            dest += stride;
+        }
+        src += 16;
+    }
+
+    scatterScalar<4>(dest, stride, src, count - i);
+}
+
+
+__attribute__((target("sse2"))) void scatter8Sse2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest),
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+        dest += stride;
+        src += 8;
+    }
+}
+
+
+__attribute__((target("sse2"))) void scatter12Sse2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Loads 16 bytes per vertex, last vertex is copied separately to not read past source end
+    for (std::size_t i = 0; i + 1 < count; i++) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), v);
+        std::int32_t value = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        std::memcpy(dest + 8, &value, 4);
+        dest += stride;
+        src += 12;
+    }
+
+    std::memcpy(dest, src, 12);
+}
+
+
+__attribute__((target("sse2"))) void scatter16Sse2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+        dest += stride;
+        src += 16;
+    }
+}
+
+
+__attribute__((target("sse2"))) void streamCopySse2(
+    std::uint8_t* dest, const std::uint8_t* src, std::size_t n)
+{
+    std::size_t head = std::min(n, (16 - reinterpret_cast<std::uintptr_t>(dest) % 16) % 16);
+    std::memcpy(dest, src, head);
+    dest += head;
+    src += head;
+    n -= head;
+
+    for (; n >= 16; n -= 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(dest),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+        dest += 16;
+        src += 16;
+    }
+
+    std::memcpy(dest, src, n);
+    _mm_sfence();
+}
+
+
+__attribute__((target("avx2"))) void scatter8Avx2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), lo);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + stride), _mm_unpackhi_epi64(lo, lo));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 2 * stride), hi);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + 3 * stride), _mm_unpackhi_epi64(hi, hi));
+
+        dest += 4 * stride;
+        src += 32;
+    }
+
+    scatterScalar<8>(dest, stride, src, count - i);
+}
+
+
+__attribute__((target("avx2"))) void scatter16Avx2(
+    std::uint8_t* dest, std::size_t stride, const std::uint8_t* src, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm256_castsi256_si128(v));
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dest + stride), _mm256_extracti128_si256(v, 1));
+
+        dest += 2 * stride;
+        src += 32;
+    }
+
+    scatterScalar<16>(dest, stride, src, count - i);
+}
+
+
+__attribute__((target("avx2"))) void streamCopyAvx2(
+    std::uint8_t* dest, const std::uint8_t* src, std::size_t n)
+{
+    std::size_t head = std::min(n, (32 - reinterpret_cast<std::uintptr_t>(dest) % 32) % 32);
+    std::memcpy(dest, src, head);
+    dest += head;
+    src += head;
+    n -= head;
+
+    for (; n >= 32; n -= 32) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(dest),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+        dest += 32;
+        src += 32;
+    }
+
+    std::memcpy(dest, src, n);
+    _mm_sfence();
+}
+
+#endif
+
+
+Kernels selectKernels()
+{
+#ifdef OGL_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {"avx2", {scatter4Sse2, scatter8Avx2, scatter12Sse2, scatter16Avx2}, streamCopyAvx2};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {"sse2", {scatter4Sse2, scatter8Sse2, scatter12Sse2, scatter16Sse2}, streamCopySse2};
+    }
+#endif
+
+    return {"scalar", {scatterScalar<4>, scatterScalar<8>, scatterScalar<12>, scatterScalar<16>},
+        streamCopyScalar};
+}
+
+
+const Kernels& kernels()
+{
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+
+std::size_t lastLevelCacheSize()
+{
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size > 0) {
+        return size;
+    }
+#endif
+
+    return 8 * 1024 * 1024;
+}
+
+}    // namespace
+
+
+void interleave(std::uint8_t* dest, std::size_t stride, const InterleaveStream* streams,
+    std::size_t numStreams, std::size_t numVertex)
+{
+    static const std::size_t cacheSize = lastLevelCacheSize();
+    alignas(64) static thread_local std::uint8_t scratch[BLOCK_SIZE];
+
+    const Kernels& selected = kernels();
+
+    // Blocks are assembled in scratch memory and streamed to destination. Only possible if
+    // streams cover whole vertex, otherwise bytes between attributes would be overwritten.
+    std::size_t coveredSize = 0;
+    for (std::size_t s = 0; s < numStreams; s++) {
+        coveredSize += streams[s].vertexSize;
+    }
+    bool nonTemporal = coveredSize == stride && stride <= BLOCK_SIZE &&
+                       numVertex * stride > cacheSize;
+
+    std::size_t blockVertex = std::max<std::size_t>(1, BLOCK_SIZE / stride);
+    for (std::size_t first = 0; first < numVertex; first += blockVertex) {
+        std::size_t count = std::min(blockVertex, numVertex - first);
+        std::uint8_t* blockDest = nonTemporal ? scratch : dest + first * stride;
+
+        for (std::size_t s = 0; s < numStreams; s++) {
+            const InterleaveStream& stream = streams[s];
+            const std::uint8_t* src =
+                static_cast<const std::uint8_t*>(stream.values) + first * stream.vertexSize;
+
+            if (stream.vertexSize % 4 == 0 && stream.vertexSize >= 4 && stream.vertexSize <= 16) {
+                selected.scatter[stream.vertexSize / 4 - 1](
+                    blockDest + stream.offset, stride, src, count);
+            }
+            else {
+                scatterGeneric(blockDest + stream.offset, stride, src, count, stream.vertexSize);
+            }
+        }
+
+        if (nonTemporal) {
+            selected.streamCopy(dest + first * stride, scratch, count * stride);
+        }
+    }
+}
+
+
+const char* interleaveKernelName()
+{
+    return kernels().name;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// Source of a single vertex attribute, values of consecutive vertices are tightly packed.
+struct InterleaveStream {
+    const void* values;
+    /// Number of bytes per vertex.
+    std::size_t vertexSize;
+    /// Byte offset of attribute inside interleaved vertex.
+    std::size_t offset;
+};
+
+
+/// @brief Interleaves multiple attribute streams into strided vertex data in a single pass.
+/// Destination is written block wise, each block stays in cache until all streams are inserted.
+/// Kernels for 4, 8, 12 and 16 byte attributes are selected at runtime depending on supported
+/// instruction sets (AVX2, SSE2, scalar fallback). Destinations larger than the last level cache
+/// are written with non-temporal stores.
+/// @param dest First byte of first vertex.
+/// @param stride Number of bytes between two consecutive vertices.
+/// @param streams Attributes to insert, `numStreams` entries.
+/// @param numVertex Number of vertices to write.
+void interleave(std::uint8_t* dest, std::size_t stride, const InterleaveStream* streams,
+    std::size_t numStreams, std::size_t numVertex);
+
+/// Returns name of kernel set used by `interleave`, one of "avx2", "sse2" or "scalar".
+const char* interleaveKernelName();
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include "mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+namespace {
+
+std::uint64_t hashBytes(const std::uint8_t* bytes, std::size_t n)
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < n; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+
+/// Triangles adjacent to each vertex, compressed row storage.
+struct Adjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+};
+
+
+Adjacency buildAdjacency(const std::uint32_t* indices, std::size_t numIndex, std::size_t numVertex)
+{
+    Adjacency adjacency;
+    adjacency.offsets.assign(numVertex + 1, 0);
+    adjacency.triangles.resize(numIndex);
+
+    for (std::size_t i = 0; i < numIndex; i++) {
+        adjacency.offsets[indices[i] + 1]++;
+    }
+    for (std::size_t v = 0; v < numVertex; v++) {
+        adjacency.offsets[v + 1] += adjacency.offsets[v];
+    }
+
+    std::vector<std::uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::size_t i = 0; i < numIndex; i++) {
+        adjacency.triangles[fill[indices[i]]++] = i / 3;
+    }
+
+    return adjacency;
+}
+
+
+/// FIFO cache simulated with time stamps, vertex is cached if inserted less than `size` misses ago.
+class FifoCache {
+  public:
+    FifoCache(std::size_t numVertex, unsigned int size)
+        : timestamps(numVertex, 0), time(size + 1), size(size) {}
+
+    /// Returns true on cache miss.
+    bool access(std::uint32_t vertex)
+    {
+        if (time - timestamps[vertex] > size) {
+            timestamps[vertex] = time++;
+            return true;
+        }
+
+        return false;
+    }
+
+    /// Evicts all vertices.
+    void flush() { time += size + 1; }
+
+  private:
+    std::vector<std::size_t> timestamps;
+    std::size_t time;
+    unsigned int size;
+};
+
+}    // namespace
+
+
+std::size_t weldVertices(const void* vertices, std::size_t numVertex, std::size_t stride,
+    void* unique, std::uint32_t* indices)
+{
+    const std::uint32_t EMPTY = UINT32_MAX;
+
+    std::size_t tableSize = 1;
+    while (tableSize < 2 * numVertex) {
+        tableSize <<= 1;
+    }
+    std::vector<std::uint32_t> table(tableSize, EMPTY);    // Open addressing, linear probing
+
+    const std::uint8_t* src = static_cast<const std::uint8_t*>(vertices);
+    std::uint8_t* dest = static_cast<std::uint8_t*>(unique);
+    std::size_t numUnique = 0;
+
+    for (std::size_t i = 0; i < numVertex; i++) {
+        const std::uint8_t* vertex = src + i * stride;
+        std::size_t slot = hashBytes(vertex, stride) & (tableSize - 1);
+
+        while (table[slot] != EMPTY &&
+               std::memcmp(dest + table[slot] * stride, vertex, stride) != 0) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+
+        if (table[slot] == EMPTY) {
+            // Only vertices before `i` have been written, safe if welding in place
+            std::memmove(dest + numUnique * stride, vertex, stride);
+            table[slot] = numUnique++;
+        }
+
+        indices[i] = table[slot];
+    }
+
+    return numUnique;
+}
+
+
+VertexCacheStats analyzeVertexCache(const std::uint32_t* indices, std::size_t numIndex,
+    std::size_t numVertex, unsigned int cacheSize)
+{
+    FifoCache cache(numVertex, cacheSize);
+    std::vector<bool> referenced(numVertex, false);
+
+    std::size_t misses = 0;
+    std::size_t numReferenced = 0;
+    for (std::size_t i = 0; i < numIndex; i++) {
+        misses += cache.access(indices[i]);
+
+        if (!referenced[indices[i]]) {
+            referenced[indices[i]] = true;
+            numReferenced++;
+        }
+    }
+
+    VertexCacheStats stats;
+    stats.acmr = numIndex == 0 ? 0.0f : (float)misses / (numIndex / 3);
+    stats.atvr = numReferenced == 0 ? 0.0f : (float)misses / numReferenced;
+
+    return stats;
+}
+
+
+OptimizationReport optimizeVertexCache(std::uint32_t* indices, std::size_t numIndex,
+    std::size_t numVertex, unsigned int cacheSize)
+{
+    OptimizationReport report;
+    report.before = analyzeVertexCache(indices, numIndex, numVertex, cacheSize);
+
+    Adjacency adjacency = buildAdjacency(indices, numIndex, numVertex);
+
+    std::vector<std::uint32_t> liveTriangles(numVertex);
+    for (std::size_t v = 0; v < numVertex; v++) {
+        liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    std::vector<std::size_t> timestamps(numVertex, 0);
+    std::vector<bool> emitted(numIndex / 3, false);
+    std::vector<std::uint32_t> deadEnd;
+    std::vector<std::uint32_t> candidates;
+    std::vector<std::uint32_t> result;
+    result.reserve(numIndex);
+
+    std::size_t time = cacheSize + 1;
+    std::size_t cursor = 0;    // Next vertex to check when dead end stack is empty
+    std::int64_t fanning = numVertex > 0 ? 0 : -1;
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        for (std::uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+            std::uint32_t triangle = adjacency.triangles[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+
+            for (int j = 0; j < 3; j++) {
+                std::uint32_t v = indices[triangle * 3 + j];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+
+                if (time - timestamps[v] > cacheSize) {
+                    timestamps[v] = time++;
+                }
+            }
+
+            emitted[triangle] = true;
+        }
+
+        // Prefer candidate which stays in cache while all its triangles are emitted, oldest first
+        fanning = -1;
+        std::size_t best = 0;
+        for (std::uint32_t v : candidates) {
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+
+            std::size_t priority = 0;
+            if (time - timestamps[v] + 2 * liveTriangles[v] <= cacheSize) {
+                priority = time - timestamps[v];
+            }
+
+            if (fanning == -1 || priority > best) {
+                best = priority;
+                fanning = v;
+            }
+        }
+
+        if (fanning != -1) {
+            continue;
+        }
+
+        while (!deadEnd.empty()) {
+            std::uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[v] > 0) {
+                fanning = v;
+                break;
+            }
+        }
+
+        while (fanning == -1 && cursor < numVertex) {
+            if (liveTriangles[cursor] > 0) {
+                fanning = cursor;
+            }
+            cursor++;
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+
+    report.after = analyzeVertexCache(indices, numIndex, numVertex, cacheSize);
+    return report;
+}
+
+
+OptimizationReport optimizeOverdraw(std::uint32_t* indices, std::size_t numIndex,
+    const float* positions, std::size_t stride, std::size_t numVertex, float threshold,
+    unsigned int cacheSize)
+{
+    OptimizationReport report;
+    report.before = analyzeVertexCache(indices, numIndex, numVertex, cacheSize);
+
+    std::size_t numTriangle = numIndex / 3;
+    auto position = [positions, stride](std::uint32_t v) {
+        return reinterpret_cast<const float*>(reinterpret_cast<const std::uint8_t*>(positions) +
+                                              v * stride);
+    };
+
+    // Misses of each triangle in current order
+    std::vector<unsigned int> misses(numTriangle);
+    FifoCache cache(numVertex, cacheSize);
+    for (std::size_t t = 0; t < numTriangle; t++) {
+        misses[t] = cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) +
+                    cache.access(indices[t * 3 + 2]);
+    }
+
+    // Hard boundaries: triangle misses all vertices, order before it does not matter for cache
+    std::vector<std::size_t> hard;
+    for (std::size_t t = 0; t < numTriangle; t++) {
+        if (t == 0 || misses[t] == 3) {
+            hard.push_back(t);
+        }
+    }
+    hard.push_back(numTriangle);
+
+    // Soft boundaries: split hard clusters where local ACMR stays within threshold
+    std::vector<std::size_t> clusters;
+    for (std::size_t c = 0; c + 1 < hard.size(); c++) {
+        std::size_t begin = hard[c];
+        std::size_t end = hard[c + 1];
+
+        std::size_t clusterMisses = 0;
+        for (std::size_t t = begin; t < end; t++) {
+            clusterMisses += misses[t];
+        }
+        float clusterThreshold = threshold * clusterMisses / (end - begin);
+
+        cache.flush();
+        std::size_t start = begin;
+        std::size_t startMisses = 0;
+        for (std::size_t t = begin; t < end; t++) {
+            startMisses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) +
+                           cache.access(indices[t * 3 + 2]);
+
+            if ((float)startMisses / (t - start + 1) <= clusterThreshold) {
+                clusters.push_back(start);
+                start = t + 1;
+                startMisses = 0;
+                cache.flush();
+            }
+        }
+
+        if (start < end) {
+            clusters.push_back(start);
+        }
+    }
+    clusters.push_back(numTriangle);
+
+    // Mesh centroid
+    double center[3] = {0, 0, 0};
+    for (std::size_t i = 0; i < numIndex; i++) {
+        const float* p = position(indices[i]);
+        for (int k = 0; k < 3; k++) {
+            center[k] += p[k];
+        }
+    }
+    for (int k = 0; k < 3; k++) {
+        center[k] /= std::max<std::size_t>(numIndex, 1);
+    }
+
+    // Sort key: distance of cluster centroid from mesh center along cluster normal
+    std::size_t numClusters = clusters.size() - 1;
+    std::vector<float> sortKey(numClusters);
+    for (std::size_t c = 0; c < numClusters; c++) {
+        double centroid[3] = {0, 0, 0};
+        double normal[3] = {0, 0, 0};
+        double area = 0;
+
+        for (std::size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const float* a = position(indices[t * 3]);
+            const float* b = position(indices[t * 3 + 1]);
+            const float* d = position(indices[t * 3 + 2]);
+
+            double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            double w[3] = {d[0] - a[0], d[1] - a[1], d[2] - a[2]};
+            double n[3] = {u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2],
+                u[0] * w[1] - u[1] * w[0]};
+            double triArea = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int k = 0; k < 3; k++) {
+                centroid[k] += (a[k] + b[k] + d[k]) / 3.0 * triArea;
+                normal[k] += n[k];
+            }
+            area += triArea;
+        }
+
+        double normalLength = std::sqrt(
+            normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        float key = 0;
+        if (area > 0 && normalLength > 0) {
+            for (int k = 0; k < 3; k++) {
+                key += (centroid[k] / area - center[k]) * normal[k] / normalLength;
+            }
+        }
+        sortKey[c] = key;
+    }
+
+    std::vector<std::size_t> order(numClusters);
+    for (std::size_t c = 0; c < numClusters; c++) {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&sortKey](std::size_t a, std::size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<std::uint32_t> result;
+    result.reserve(numIndex);
+    for (std::size_t c : order) {
+        result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+    std::copy(result.begin(), result.end(), indices);
+
+    report.after = analyzeVertexCache(indices, numIndex, numVertex, cacheSize);
+    return report;
+}
+
+
+std::size_t optimizeVertexFetch(void* vertices, std::size_t numVertex, std::size_t stride,
+    std::uint32_t* indices, std::size_t numIndex)
+{
+    const std::uint32_t UNUSED = UINT32_MAX;
+    std::vector<std::uint32_t> remap(numVertex, UNUSED);
+
+    std::size_t numUsed = 0;
+    for (std::size_t i = 0; i < numIndex; i++) {
+        if (remap[indices[i]] == UNUSED) {
+            remap[indices[i]] = numUsed++;
+        }
+        indices[i] = remap[indices[i]];
+    }
+
+    std::uint8_t* data = static_cast<std::uint8_t*>(vertices);
+    std::vector<std::uint8_t> reordered(numUsed * stride);
+    for (std::size_t v = 0; v < numVertex; v++) {
+        if (remap[v] != UNUSED) {
+            std::memcpy(reordered.data() + remap[v] * stride, data + v * stride, stride);
+        }
+    }
+    std::memcpy(data, reordered.data(), reordered.size());
+
+    return numUsed;
+}
\ No newline at end of file
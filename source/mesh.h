@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+/// Post transform vertex cache efficiency of an index list.
+struct VertexCacheStats {
+    /// Average cache miss ratio, transformed vertices per triangle. Between 0.5 (ideal) and 3.
+    float acmr;
+    /// Average transformed to vertex ratio, transformed vertices per referenced vertex. 1 is ideal.
+    float atvr;
+};
+
+
+/// Cache efficiency before and after an optimisation step.
+struct OptimizationReport {
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+
+/// Default size of simulated FIFO post transform cache.
+constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+
+/// @brief Merges identical vertices and creates an index list referencing unique vertices.
+/// Vertices are compared bytewise, so interleaved data of all attributes is considered.
+/// @param vertices `numVertex` interleaved vertices, `stride` bytes each.
+/// @param unique Receives unique vertices in order of first occurrence, must hold `numVertex`
+/// vertices. May be equal to @p vertices to weld in place.
+/// @param indices Receives `numVertex` indices into @p unique.
+/// @return Number of unique vertices.
+std::size_t weldVertices(const void* vertices, std::size_t numVertex, std::size_t stride,
+    void* unique, std::uint32_t* indices);
+
+
+/// @brief Simulates a FIFO post transform cache for a triangle list.
+VertexCacheStats analyzeVertexCache(const std::uint32_t* indices, std::size_t numIndex,
+    std::size_t numVertex, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+/// @brief Reorders triangles to reduce vertex shader invocations (Tipsify).
+/// @param indices Triangle list, `numIndex` indices referencing `numVertex` vertices. Reordered in
+/// place.
+OptimizationReport optimizeVertexCache(std::uint32_t* indices, std::size_t numIndex,
+    std::size_t numVertex, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+/// @brief Reorders clusters of a cache optimised triangle list to reduce overdraw.
+/// Index list is split into clusters at cache flushes and where splitting keeps ACMR within
+/// @p threshold times the cluster ACMR. Clusters facing away from mesh center are drawn first.
+/// @param positions First position, 3 floats each, consecutive positions `stride` bytes apart.
+/// @param threshold Allowed ACMR degradation, e.g. 1.05.
+OptimizationReport optimizeOverdraw(std::uint32_t* indices, std::size_t numIndex,
+    const float* positions, std::size_t stride, std::size_t numVertex, float threshold = 1.05f,
+    unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+/// @brief Reorders vertices in order of first use, so vertex memory is accessed linearly.
+/// Indices are remapped accordingly, unused vertices are removed.
+/// @param vertices `numVertex` interleaved vertices, `stride` bytes each. Reordered in place.
+/// @return Number of vertices remaining.
+std::size_t optimizeVertexFetch(void* vertices, std::size_t numVertex, std::size_t stride,
+    std::uint32_t* indices, std::size_t numIndex);
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <cstring>
+#include <cstddef>
+
+#include "buffer.h"
 
 
 template<typename T>
@@ -15,8 +17,11 @@ struct Rectangle {
 };
 
 
+/// @brief Writes two triangles covering `rect`.
+/// @param uvRect Texture region mapped onto `rect`, `uvRect->y1` is mapped to top edge.
 template<typename T>
-void getVertexData(const Rectangle<T>* rect, T* pos, T* uv)
+void getVertexData(
+    const Rectangle<T>* rect, const Rectangle<T>* uvRect, VertexView<T> pos, VertexView<T> uv)
 {
     const T positions[12] = {
         rect->x1, rect->y1,
@@ -26,15 +31,35 @@ void getVertexData(const Rectangle<T>* rect, T* pos, T* uv)
         rect->x2, rect->y2,
         rect->x2, rect->y1
     };
-    std::memcpy(pos, positions, 12 * sizeof(T));
 
     const T uvs[12] = {
-        0, 1,
-        0, 0,
-        1, 0,
-        0, 1,
-        1, 0,
-        1, 1
+        uvRect->x1, uvRect->y2,
+        uvRect->x1, uvRect->y1,
+        uvRect->x2, uvRect->y1,
+        uvRect->x1, uvRect->y2,
+        uvRect->x2, uvRect->y1,
+        uvRect->x2, uvRect->y2
     };
-    std::memcpy(uv, uvs, 12 * sizeof(T));
+
+    for (std::size_t i = 0; i < 6; i++) {
+        pos[i][0] = positions[2 * i];
+        pos[i][1] = positions[2 * i + 1];
+        uv[i][0] = uvs[2 * i];
+        uv[i][1] = uvs[2 * i + 1];
+    }
+}
+
+
+template<typename T>
+void getVertexData(const Rectangle<T>* rect, VertexView<T> pos, VertexView<T> uv)
+{
+    const Rectangle<T> uvRect(0, 1, 0, 1);
+    getVertexData(rect, &uvRect, pos, uv);
+}
+
+
+template<typename T>
+void getVertexData(const Rectangle<T>* rect, T* pos, T* uv)
+{
+    getVertexData(rect, VertexView<T>(pos, 2 * sizeof(T), 6), VertexView<T>(uv, 2 * sizeof(T), 6));
 }
\ No newline at end of file
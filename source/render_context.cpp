@@ -2,13 +2,70 @@
 
 #include <GL/Glew.h>
 
+#include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <vector>
 
 #include "buffer.h"
+#include "convert.h"
+#include "gl_state.h"
+#include "interleave.h"
 #include "utility.h"
 
 
+DrawBatch::~DrawBatch()
+{
+    if (indirectId != 0) {
+        GLState::deleteBuffers(1, &indirectId);
+    }
+}
+
+
+void DrawBatch::add(unsigned int first, unsigned int count)
+{
+    if (!_firsts.empty() && (unsigned int)(_firsts.back() + _counts.back()) == first) {
+        _counts.back() += count;
+        return;
+    }
+
+    _firsts.push_back(first);
+    _counts.push_back(count);
+}
+
+
+void DrawBatch::clear()
+{
+    _firsts.clear();
+    _counts.clear();
+}
+
+
+GLuint DrawBatch::uploadCommands()
+{
+    if (indirectId == 0) {
+        glGenBuffers(1, &indirectId);
+    }
+
+    commands.resize(_firsts.size());
+    for (std::size_t i = 0; i < _firsts.size(); i++) {
+        commands[i] = {(GLuint)_counts[i], 1, (GLuint)_firsts[i], 0};
+    }
+
+    std::size_t size = commands.size() * sizeof(DrawArraysCommand);
+    GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectId);
+    if (size > gpuSize) {
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, size, commands.data(), GL_STREAM_DRAW);
+        gpuSize = size;
+    }
+    else {
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data());
+    }
+
+    return indirectId;
+}
+
+
 VAO::VAO(GLenum renderMode) : renderMode(renderMode)
 {
     glGenVertexArrays(1, &id);
@@ -17,7 +74,11 @@ VAO::VAO(GLenum renderMode) : renderMode(renderMode)
 
 VAO::~VAO()
 {
+    GLState::deleteVertexArrays(1, &id);
+
     delete[] buffers;
+    delete[] boundIds;
+    delete[] boundOffsets;
 
     for (AttributeBinding* binding : attribBindings) {
         delete binding;
@@ -25,14 +86,15 @@ VAO::~VAO()
 }
 
 
-const AttributeBinding* VAO::bindBuffer(
-    const VertexAttribute* attribute, unsigned int index, VertexBuffer* buffer, std::size_t valSize)
+const AttributeBinding* VAO::bindBuffer(const VertexAttribute* attribute, unsigned int index,
+    VertexBuffer* buffer, std::size_t valSize, unsigned int divisor)
 {
     AttributeBinding* binding = new AttributeBinding;
     binding->attribute = attribute;
     binding->buffer = buffer;
     binding->index = index;
     binding->valSize = valSize;
+    binding->divisor = divisor;
     binding->offset = 0;
     binding->stride = -1;  // Set when all attributes for buffer are bound
 
@@ -51,11 +113,28 @@ const AttributeBinding* VAO::bindBuffer(
 }
 
 
+const AttributeBinding* VAO::bindBuffer(
+    const VertexAttribute* attribute, unsigned int index, VertexBuffer* buffer)
+{
+    std::size_t valSize = packedSize(attribute->glType, attribute->size) / attribute->size;
+    return bindBuffer(attribute, index, buffer, valSize);
+}
+
+
+void VAO::bindIndices(IndexBuffer* indices)
+{
+    this->indices = indices;
+
+    GLState::bindVertexArray(id);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices == nullptr ? 0 : indices->id());
+}
+
+
 void VAO::initialize()
 {
     buffers = new VertexBuffer*[numBuffers];
-    
-    glBindVertexArray(id);
+    boundIds = new GLuint[numBuffers];
+    boundOffsets = new std::size_t[numBuffers];
     
     std::size_t bufferIdx = 0;
     std::size_t stride;
@@ -69,25 +148,76 @@ void VAO::initialize()
         }
 
         binding->stride = stride;
+    }
+
+    // Enabled arrays are VAO state, so they are enabled once instead of around each draw
+    GLState::bindVertexArray(id);
+    for (std::size_t i = 0; i < numBuffers; i++) {
+        setAttribPointers(i);
+    }
+    for (AttributeBinding* binding : attribBindings) {
+        glEnableVertexAttribArray((GLint)(binding->index));
+    }
+}
+
+
+void VAO::setAttribPointers(std::size_t bufferIdx)
+{
+    VertexBuffer* buffer = buffers[bufferIdx];
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffer->id());
+    for (AttributeBinding* binding : attribBindings) {
+        if (binding->buffer != buffer) {
+            continue;
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, binding->buffer->id());
         glVertexAttribPointer(
             binding->index,
             binding->attribute->size,
             binding->attribute->glType,
             binding->attribute->normalized,
             binding->stride,
-            (void*)binding->offset
+            (void*)(binding->offset + buffer->gpuOffset() + instanceOffset(binding))
         );
+        glVertexAttribDivisor(binding->index, binding->divisor);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    boundIds[bufferIdx] = buffer->id();
+    boundOffsets[bufferIdx] = buffer->gpuOffset();
+}
+
+
+bool VAO::hasBaseInstance()
+{
+    return GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+}
+
+
+std::size_t VAO::instanceOffset(const AttributeBinding* binding) const
+{
+    // Base instance is not divided by divisor
+    return binding->divisor > 0 ? instanceBase * binding->stride : 0;
+}
+
+
+void VAO::setInstanceBase(unsigned int baseInstance)
+{
+    if (hasBaseInstance() || baseInstance == instanceBase) {
+        return;
+    }
+
+    instanceBase = baseInstance;
+    for (std::size_t i = 0; i < numBuffers; i++) {
+        setAttribPointers(i);
+    }
 }
 
 
 void VAO::begin()
-{    
+{
+    for (std::size_t i = 0; i < numBuffers; i++) {
+        buffers[i]->begin();
+    }
 }
 
 
@@ -95,6 +225,16 @@ void VAO::end()
 {
     for (std::size_t i = 0; i < numBuffers; i++) {
         buffers[i]->use(renderMode);
+
+        // Buffer storage was reallocated or data moved to other region
+        if (buffers[i]->id() != boundIds[i] || buffers[i]->gpuOffset() != boundOffsets[i]) {
+            GLState::bindVertexArray(id);
+            setAttribPointers(i);
+        }
+    }
+
+    if (indices != nullptr) {
+        indices->use(renderMode);
     }
 
     numVertex = attribBindings[0]->buffer->size() / attribBindings[0]->stride;
@@ -104,23 +244,149 @@ void VAO::end()
 void VAO::addData(const AttributeBinding* binding, const void* data, unsigned int numVertex,
     unsigned int vertexOffset)
 {
+    // Stride is unknown until `initialize`
+    assert(binding->stride != (std::size_t)-1);
+
     std::size_t vertexSize = binding->valSize * binding->attribute->size;
-    std::size_t offset = binding->offset + vertexOffset * vertexSize;
+    std::size_t offset = binding->offset + vertexOffset * binding->stride;
     binding->buffer->add(
-        data, numVertex * vertexSize, vertexSize, binding->stride, binding->offset
+        data, numVertex * vertexSize, vertexSize, binding->stride, offset
     );
 }
 
 
-void VAO::render(unsigned int offset, unsigned int numVertex)
+void VAO::addConverted(const AttributeBinding* binding, const float* data, unsigned int numVertex,
+    unsigned int vertexOffset)
 {
-    glBindVertexArray(id);
-    for (AttributeBinding* binding : attribBindings) {
-        glEnableVertexAttribArray((GLint)(binding->index));
+    std::size_t vertexSize = binding->valSize * binding->attribute->size;
+    assert(packedSize(binding->attribute->glType, binding->attribute->size) == vertexSize);
+
+    std::vector<std::uint8_t> packed(numVertex * vertexSize);
+    packFloats(data, numVertex, binding->attribute->size, binding->attribute->glType,
+        binding->attribute->normalized, packed.data());
+
+    addData(binding, packed.data(), numVertex, vertexOffset);
+}
+
+
+void VAO::addData(const AttributeBinding* const* bindings, const void* const* data,
+    std::size_t numBindings, unsigned int numVertex, unsigned int vertexOffset)
+{
+    VertexBuffer* buffer = bindings[0]->buffer;
+    std::size_t stride = bindings[0]->stride;
+    assert(stride != (std::size_t)-1);
+
+    std::vector<InterleaveStream> streams(numBindings);
+    for (std::size_t i = 0; i < numBindings; i++) {
+        assert(bindings[i]->buffer == buffer);
+
+        streams[i].values = data[i];
+        streams[i].vertexSize = bindings[i]->valSize * bindings[i]->attribute->size;
+        streams[i].offset = bindings[i]->offset;
     }
+
+    std::uint8_t* dest = buffer->reserve(numVertex * stride, stride, stride, vertexOffset * stride);
+    interleave(dest, stride, streams.data(), numBindings, numVertex);
+}
+
+
+void VAO::render(unsigned int offset, unsigned int numVertex)
+{
+    GLState::bindVertexArray(id);
     glDrawArrays(GL_TRIANGLES, offset, numVertex);
-    for (AttributeBinding* binding : attribBindings) {
-        glDisableVertexAttribArray((GLint)(binding->index));
+}
+
+
+void VAO::renderIndexed(unsigned int offset, unsigned int numIndex, int baseVertex)
+{
+    void* first = (void*)(offset * indices->indexSize());
+
+    GLState::bindVertexArray(id);
+    if (baseVertex == 0) {
+        glDrawElements(GL_TRIANGLES, numIndex, indices->type(), first);
     }
-    glBindVertexArray(0);
+    else {
+        glDrawElementsBaseVertex(GL_TRIANGLES, numIndex, indices->type(), first, baseVertex);
+    }
+}
+
+
+void VAO::renderMulti(const GLint* firsts, const GLsizei* counts, GLsizei numDraws)
+{
+    GLState::bindVertexArray(id);
+    glMultiDrawArrays(GL_TRIANGLES, firsts, counts, numDraws);
+}
+
+
+void VAO::renderMulti(DrawBatch& batch)
+{
+    if (batch.size() == 0) {
+        return;
+    }
+
+    if (!GLEW_VERSION_4_3 && !GLEW_ARB_multi_draw_indirect) {
+        renderMulti(batch.firsts(), batch.counts(), batch.size());
+        return;
+    }
+
+    GLuint commands = batch.uploadCommands();
+
+    GLState::bindVertexArray(id);
+    GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+    glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, batch.size(), 0);
+}
+
+
+void VAO::renderInstanced(unsigned int offset, unsigned int numVertex,
+    unsigned int numInstances, unsigned int baseInstance)
+{
+    GLState::bindVertexArray(id);
+    setInstanceBase(baseInstance);
+    if (!hasBaseInstance()) {
+        baseInstance = 0;
+    }
+
+    if (baseInstance == 0) {
+        glDrawArraysInstanced(GL_TRIANGLES, offset, numVertex, numInstances);
+    }
+    else {
+        glDrawArraysInstancedBaseInstance(
+            GL_TRIANGLES, offset, numVertex, numInstances, baseInstance);
+    }
+}
+
+
+void VAO::renderIndexedInstanced(unsigned int offset, unsigned int numIndex,
+    unsigned int numInstances, unsigned int baseInstance, int baseVertex)
+{
+    void* first = (void*)(offset * indices->indexSize());
+
+    GLState::bindVertexArray(id);
+    setInstanceBase(baseInstance);
+    if (!hasBaseInstance()) {
+        baseInstance = 0;
+    }
+
+    if (baseInstance == 0 && baseVertex == 0) {
+        glDrawElementsInstanced(GL_TRIANGLES, numIndex, indices->type(), first, numInstances);
+    }
+    else if (baseInstance == 0) {
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES, numIndex, indices->type(), first, numInstances, baseVertex);
+    }
+    else if (baseVertex == 0) {
+        glDrawElementsInstancedBaseInstance(
+            GL_TRIANGLES, numIndex, indices->type(), first, numInstances, baseInstance);
+    }
+    else {
+        glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, numIndex, indices->type(),
+            first, numInstances, baseVertex, baseInstance);
+    }
+}
+
+
+void VAO::render(const PoolAllocation& allocation)
+{
+    // Allocation start acts as base vertex
+    render(allocation.first, allocation.count);
 }
\ No newline at end of file
@@ -2,10 +2,12 @@
 
 #include <GL/Glew.h>
 
+#include <cassert>
 #include <cstddef>
 #include <vector>
 
 #include "buffer.h"
+#include "buffer_pool.h"
 
 
 struct VertexAttribute {
@@ -23,6 +25,45 @@ struct AttributeBinding {
     std::size_t offset;
     std::size_t stride;
     std::size_t valSize;
+    // Number of instances sharing one value, 0 for per vertex data
+    unsigned int divisor;
+};
+
+
+/// @brief Collects vertex ranges drawn during a frame for submission in a single call.
+/// Ranges continuing the previous range are merged.
+class DrawBatch {
+  public:
+    DrawBatch() = default;
+    ~DrawBatch();
+
+    /// @brief Adds range of vertices to draw.
+    void add(unsigned int first, unsigned int count);
+
+    /// @brief Removes all ranges.
+    void clear();
+
+    std::size_t size() const { return _firsts.size(); }
+    const GLint* firsts() const { return _firsts.data(); }
+    const GLsizei* counts() const { return _counts.data(); }
+
+    /// @brief Copies ranges as indirect draw commands to GPU.
+    /// @return Id of buffer to bind as `GL_DRAW_INDIRECT_BUFFER`.
+    GLuint uploadCommands();
+
+  private:
+    struct DrawArraysCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint first;
+        GLuint baseInstance;
+    };
+
+    std::vector<GLint> _firsts;
+    std::vector<GLsizei> _counts;
+    std::vector<DrawArraysCommand> commands;
+    std::size_t gpuSize = 0;
+    GLuint indirectId = 0;
 };
 
 
@@ -36,39 +77,148 @@ class VAO {
     /// @param index Index of vertex attribute in shader.
     /// @param buffer Where vertex data is stored (before send to GPU memory).
     /// @param valSize Size in bytes of single vertex attribute value.
+    /// @param divisor If non zero, attribute advances once per @p divisor instances instead of once
+    /// per vertex.
     /// return Binding reference.
     const AttributeBinding* bindBuffer(const VertexAttribute* attribute, unsigned int index,
-        VertexBuffer* buffer, std::size_t valSize);
+        VertexBuffer* buffer, std::size_t valSize, unsigned int divisor = 0);
+
+    /// @brief Creates binding, value size is derived from storage type of @p attribute.
+    /// Packed types like `GL_INT_2_10_10_10_REV` count as 1 byte per component.
+    const AttributeBinding* bindBuffer(
+        const VertexAttribute* attribute, unsigned int index, VertexBuffer* buffer);
+
+    /// @brief Sets buffer providing indices for `renderIndexed`.
+    void bindIndices(IndexBuffer* indices);
 
     /// @brief Initializes VAO by specifying attribute data layouts.
     /// Should be called after all attributes are bound to VAO.
     void initialize();
 
     /// @brief Initializes data collection.
+    /// Must be called before adding data to a `StreamingBuffer` each frame.
     void begin();
 
     /// @brief Signals that no more data will be added.
+    /// Uploads vertex data modified since last call to GPU.
     void end();
 
     /// @brief Copies vertex data into buffer.
     /// @param binding Buffer binding to insert values into.
     /// @param data Values to insert into buffer.
     /// @param numVertex Number of vertices to insert.
+    /// @param vertexOffset Index of first vertex to overwrite.
     void addData(const AttributeBinding* binding, const void* data, unsigned int numVertex,
         unsigned int vertexOffset = 0);
 
+    /// @brief Converts float vertex data into storage type of binding and copies it into buffer.
+    /// Allows storing attributes as half floats, normalized integers or packed 10/10/10/2 values
+    /// while callers supply floats.
+    /// @param binding Buffer binding to insert values into.
+    /// @param data `numVertex * attribute->size` values to convert.
+    /// @param numVertex Number of vertices to insert.
+    /// @param vertexOffset Index of first vertex to overwrite.
+    void addConverted(const AttributeBinding* binding, const float* data, unsigned int numVertex,
+        unsigned int vertexOffset = 0);
+
+    /// @brief Copies vertex data of multiple attributes into buffer in a single pass.
+    /// All bindings have to refer to same buffer.
+    /// @param bindings, data `numBindings` bindings and values to insert for each binding.
+    /// @param numVertex Number of vertices to insert.
+    /// @param vertexOffset Index of first vertex to overwrite.
+    void addData(const AttributeBinding* const* bindings, const void* const* data,
+        std::size_t numBindings, unsigned int numVertex, unsigned int vertexOffset = 0);
+
+    /// @brief Reserves space for vertex data to be written in place.
+    /// Avoids staging data in a separate array, values are written directly into buffer storage
+    /// in its interleaved layout.
+    /// @tparam T Type of single attribute value, `sizeof(T)` should equal `valSize` of binding.
+    /// @param binding Buffer binding to reserve values for.
+    /// @param numVertex Number of vertices to reserve.
+    /// @param vertexOffset Index of first vertex to reserve.
+    /// @return View on reserved vertices. Invalidated by next insertion into same buffer.
+    template<typename T>
+    static VertexView<T> reserve(const AttributeBinding* binding, unsigned int numVertex,
+        unsigned int vertexOffset = 0)
+    {
+        // Stride is unknown until `initialize`
+        assert(binding->stride != (std::size_t)-1);
+
+        std::size_t vertexSize = binding->valSize * binding->attribute->size;
+        std::uint8_t* first = binding->buffer->reserve(numVertex * vertexSize, vertexSize,
+            binding->stride, binding->offset + vertexOffset * binding->stride);
+
+        return VertexView<T>(first, binding->stride, numVertex);
+    }
+
     /// @brief Renders all added vertices.
     /// @param offset Index of first vertex to draw.
     /// @param numVertex Number of vertices to draw.
     void render(unsigned int offset, unsigned int numVertex);
 
+    /// @brief Renders vertices referenced by bound index buffer.
+    /// @param offset Position of first index to use.
+    /// @param numIndex Number of indices to draw.
+    /// @param baseVertex Added to each index before fetching vertex, e.g. `PoolAllocation::first`.
+    void renderIndexed(unsigned int offset, unsigned int numIndex, int baseVertex = 0);
+
+    /// @brief Renders multiple vertex ranges with a single call.
+    /// @param firsts, counts Index of first vertex and number of vertices of each range.
+    /// @param numDraws Number of ranges.
+    void renderMulti(const GLint* firsts, const GLsizei* counts, GLsizei numDraws);
+
+    /// @brief Renders all ranges of @p batch with a single call.
+    /// Uses indirect draw commands stored on GPU if supported, `glMultiDrawArrays` otherwise.
+    void renderMulti(DrawBatch& batch);
+
+    /// @brief Renders multiple instances of added vertices.
+    /// @param offset Index of first vertex to draw.
+    /// @param numVertex Number of vertices per instance.
+    /// @param numInstances Number of instances to draw.
+    /// @param baseInstance Index of first instance value to fetch from per instance attributes.
+    /// Without GL 4.2 or `GL_ARB_base_instance` per instance attribute pointers are moved to it
+    /// instead.
+    void renderInstanced(unsigned int offset, unsigned int numVertex, unsigned int numInstances,
+        unsigned int baseInstance = 0);
+
+    /// @brief Renders multiple instances of vertices referenced by bound index buffer.
+    /// @param offset Position of first index to use.
+    /// @param numIndex Number of indices per instance.
+    /// @param numInstances Number of instances to draw.
+    /// @param baseInstance Index of first instance value to fetch from per instance attributes,
+    /// see `renderInstanced`.
+    /// @param baseVertex Added to each index before fetching vertex.
+    void renderIndexedInstanced(unsigned int offset, unsigned int numIndex,
+        unsigned int numInstances, unsigned int baseInstance = 0, int baseVertex = 0);
+
+    /// @brief Renders vertices of a pool allocation.
+    /// Page buffer of @p allocation has to be bound to this VAO.
+    void render(const PoolAllocation& allocation);
+
     unsigned int getNumVertex() { return numVertex; }
 
   private:
+    /// Specifies layout of all attributes stored in `buffers[bufferIdx]`. VAO must be bound.
+    void setAttribPointers(std::size_t bufferIdx);
+
+    /// Returns whether draws can start at an instance other than 0.
+    static bool hasBaseInstance();
+    /// Returns byte offset of first value fetched for @p binding due to `instanceBase`.
+    std::size_t instanceOffset(const AttributeBinding* binding) const;
+    /// Moves per instance attribute pointers to @p baseInstance if base instance draws are not
+    /// supported. VAO must be bound.
+    void setInstanceBase(unsigned int baseInstance);
+
     GLuint id;
     GLenum renderMode;
     std::vector<AttributeBinding*> attribBindings;
     std::size_t numBuffers = 0;
-    VertexBuffer** buffers;
+    VertexBuffer** buffers = nullptr;
+    // GPU buffer id and offset attribute pointers were last specified with, per buffer
+    GLuint* boundIds = nullptr;
+    std::size_t* boundOffsets = nullptr;
+    IndexBuffer* indices = nullptr;
     unsigned int numVertex = 0;
+    // Instance per instance attribute pointers start at, without base instance support
+    unsigned int instanceBase = 0;
 };
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "render_queue.h"
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gl_state.h"
+
+
+std::uint64_t RenderQueue::makeKey(std::uint8_t layer, std::uint16_t program, std::uint8_t state,
+    std::uint16_t texture, std::uint16_t vao)
+{
+    return (std::uint64_t)layer << 56 | (std::uint64_t)program << 40 | (std::uint64_t)state << 32 |
+           (std::uint64_t)texture << 16 | (std::uint64_t)vao;
+}
+
+
+void RenderQueue::submit(const DrawItem& item)
+{
+    entries.push_back({item.key, (std::uint32_t)items.size()});
+    items.push_back(item);
+}
+
+
+void RenderQueue::flush()
+{
+    unsorted = measure();
+    sort();
+    sorted = measure();
+
+    const DrawItem* previous = nullptr;
+    const DrawItem* batch = nullptr;
+    unsigned int count = 0;
+    for (const SortEntry& entry : entries) {
+        const DrawItem& item = items[entry.index];
+        if (batch != nullptr && compatible(*batch, item) && item.first == batch->first + count) {
+            count += item.count;
+            continue;
+        }
+
+        if (batch != nullptr) {
+            draw(*batch, count, previous);
+            previous = batch;
+        }
+        batch = &item;
+        count = item.count;
+    }
+
+    if (batch != nullptr) {
+        draw(*batch, count, previous);
+    }
+
+    items.clear();
+    entries.clear();
+}
+
+
+bool RenderQueue::compatible(const DrawItem& a, const DrawItem& b)
+{
+    for (unsigned int i = 0; i < DrawItem::maxTextures; i++) {
+        if (a.textures[i] != b.textures[i]) {
+            return false;
+        }
+    }
+
+    return a.program == b.program && a.vao == b.vao && a.state == b.state &&
+           a.indexed == b.indexed && a.baseVertex == b.baseVertex;
+}
+
+
+RenderQueueStats RenderQueue::measure() const
+{
+    RenderQueueStats stats = {0, 0, 0, 0, 0};
+
+    const DrawItem* previous = nullptr;
+    unsigned int end = 0;
+    for (const SortEntry& entry : entries) {
+        const DrawItem& item = items[entry.index];
+
+        if (previous == nullptr || !compatible(*previous, item) || item.first != end) {
+            stats.drawCalls++;
+        }
+        stats.programChanges += previous == nullptr || previous->program != item.program;
+        stats.vaoChanges += previous == nullptr || previous->vao != item.vao;
+        stats.stateChanges += previous == nullptr || !(previous->state == item.state);
+        for (unsigned int i = 0; i < DrawItem::maxTextures; i++) {
+            bool bound = previous != nullptr && previous->textures[i] == item.textures[i];
+            stats.textureChanges += item.textures[i] != 0 && !bound;
+        }
+
+        previous = &item;
+        end = item.first + item.count;
+    }
+
+    return stats;
+}
+
+
+void RenderQueue::sort()
+{
+    if (entries.empty()) {
+        return;
+    }
+
+    scratch.resize(entries.size());
+    for (unsigned int shift = 0; shift < 64; shift += 8) {
+        // offsets[b + 1] counts keys with byte b, turned into start of bucket b below
+        std::size_t offsets[257] = {};
+        for (const SortEntry& entry : entries) {
+            offsets[((entry.key >> shift) & 0xFF) + 1]++;
+        }
+
+        // Pass would not change order if all keys share this byte
+        if (offsets[((entries[0].key >> shift) & 0xFF) + 1] == entries.size()) {
+            continue;
+        }
+
+        for (unsigned int i = 1; i < 257; i++) {
+            offsets[i] += offsets[i - 1];
+        }
+        for (const SortEntry& entry : entries) {
+            scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+}
+
+
+void RenderQueue::draw(const DrawItem& item, unsigned int count, const DrawItem* previous)
+{
+    // `use` also runs setting callbacks and uploads uniforms, only call it on switches
+    if (previous == nullptr || previous->program != item.program) {
+        item.program->use();
+    }
+
+    for (unsigned int i = 0; i < DrawItem::maxTextures; i++) {
+        if (item.textures[i] != 0) {
+            GLState::bindTexture(GL_TEXTURE0 + i, GL_TEXTURE_2D, item.textures[i]);
+        }
+    }
+
+    if (item.state.blend) {
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(item.state.blendSource, item.state.blendDestination);
+    }
+    else {
+        GLState::disable(GL_BLEND);
+    }
+
+    if (item.state.depthTest) {
+        GLState::enable(GL_DEPTH_TEST);
+        GLState::depthFunc(item.state.depthFunc);
+    }
+    else {
+        GLState::disable(GL_DEPTH_TEST);
+    }
+
+    if (item.indexed) {
+        item.vao->renderIndexed(item.first, count, item.baseVertex);
+    }
+    else {
+        item.vao->render(item.first, count);
+    }
+}
\ No newline at end of file
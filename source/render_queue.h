@@ -0,0 +1,106 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "render_context.h"
+#include "shader.h"
+
+
+/// Fixed function state a draw item is rendered with, applied through `GLState`.
+struct RenderState {
+    bool blend;
+    GLenum blendSource;
+    GLenum blendDestination;
+    bool depthTest;
+    GLenum depthFunc;
+
+    bool operator==(const RenderState& other) const = default;
+};
+
+
+/// Single draw call submitted to a `RenderQueue`.
+struct DrawItem {
+    static constexpr unsigned int maxTextures = 4;
+
+    /// Items are drawn in ascending key order, see `RenderQueue::makeKey`.
+    std::uint64_t key;
+    const ShaderProgram* program;
+    VAO* vao;
+    /// `GL_TEXTURE_2D` textures bound to units 0 to 3, 0 leaves unit unchanged.
+    GLuint textures[maxTextures];
+    RenderState state;
+    /// Index of first vertex, or first index if `indexed`.
+    unsigned int first;
+    /// Number of vertices, or indices if `indexed`.
+    unsigned int count;
+    bool indexed;
+    int baseVertex;
+};
+
+
+/// Number of draw calls and state switches needed to draw a sequence of draw items.
+struct RenderQueueStats {
+    std::size_t drawCalls;
+    std::size_t programChanges;
+    std::size_t textureChanges;
+    std::size_t vaoChanges;
+    std::size_t stateChanges;
+};
+
+
+/// @brief Collects draw items of a frame and submits them ordered by their sort key.
+/// Keys should place the most expensive switches in their most significant bits, so sorting
+/// groups items sharing a program, then textures and VAO. Consecutive items differing only in
+/// their vertex range are merged into one draw call if the ranges are adjacent. Items with equal
+/// keys keep their submission order.
+/// Uniforms are not part of items, values written to a program before `flush` apply to all of its
+/// items.
+class RenderQueue {
+  public:
+    /// @brief Packs sort key, each field is truncated to its width.
+    /// From most significant bit: layer (8 bits), program (16), render state (8), texture (16)
+    /// and VAO (16). Ids are chosen by the caller, e.g. indices into its own tables, layers order
+    /// passes like opaque before transparent geometry.
+    static std::uint64_t makeKey(std::uint8_t layer, std::uint16_t program, std::uint8_t state,
+        std::uint16_t texture, std::uint16_t vao);
+
+    /// @brief Adds item to be drawn by next `flush`.
+    void submit(const DrawItem& item);
+
+    /// @brief Sorts and draws all submitted items, then empties queue.
+    /// Storage is kept, so queues refilled every frame do not allocate once grown.
+    void flush();
+
+    /// Returns number of items submitted since last `flush`.
+    std::size_t size() const { return items.size(); }
+    /// Returns stats of items of last `flush` if they were drawn in submission order.
+    const RenderQueueStats& unsortedStats() const { return unsorted; }
+    /// Returns stats of items of last `flush` as drawn.
+    const RenderQueueStats& sortedStats() const { return sorted; }
+
+  private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t index;
+    };
+
+    /// Returns whether items can be drawn with the same state, ignoring their ranges.
+    static bool compatible(const DrawItem& a, const DrawItem& b);
+
+    /// Counts draw calls and state switches of items in order of `entries`.
+    RenderQueueStats measure() const;
+    /// Stable LSD radix sort of `entries` by key, one pass per byte.
+    void sort();
+    /// Applies state of @p item not already set by @p previous and draws @p count elements.
+    void draw(const DrawItem& item, unsigned int count, const DrawItem* previous);
+
+    std::vector<DrawItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    RenderQueueStats unsorted = {0, 0, 0, 0, 0};
+    RenderQueueStats sorted = {0, 0, 0, 0, 0};
+};
\ No newline at end of file
@@ -1,13 +1,107 @@
 #include "shader.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
 
-GLuint compileShader(const char* vertexSource, const char* fragmentSource)
+#include "gl_state.h"
+
+
+const ShaderProgram* ShaderProgram::active = nullptr;
+std::string ShaderProgram::cacheDirectory;
+
+
+namespace {
+
+/// Identifies program cache files, followed by format version.
+const std::uint32_t CACHE_MAGIC = 0x42504C4F;
+const std::uint32_t CACHE_VERSION = 1;
+
+
+/// 64 bit FNV-1a, continuing from @p hash.
+std::uint64_t hashBytes(const char* data, std::size_t size, std::uint64_t hash)
+{
+    for (std::size_t i = 0; i < size; i++) {
+        hash = (hash ^ (unsigned char)data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+
+template<typename T> void writeValue(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+template<typename T> bool readValue(std::istream& in, T* value)
+{
+    return (bool)in.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+
+void writeString(std::ostream& out, const std::string& value)
+{
+    writeValue(out, (std::uint32_t)value.size());
+    out.write(value.data(), value.size());
+}
+
+
+/// Returns whether at least @p size bytes are left, so damaged lengths are not allocated.
+bool hasBytes(std::istream& in, std::uint64_t size)
+{
+    std::streampos position = in.tellg();
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(position);
+
+    return position != std::streampos(-1) && (std::uint64_t)(end - position) >= size;
+}
+
+
+bool readString(std::istream& in, std::string* value)
+{
+    std::uint32_t size;
+    if (!readValue(in, &size) || !hasBytes(in, size)) {
+        return false;
+    }
+    value->resize(size);
+    return (bool)in.read(value->data(), size);
+}
+
+
+/// @brief Compiles and links program without querying any status.
+/// Queries would wait for the driver, which may otherwise compile in the background.
+GLuint submitProgram(const char* vertexSource, const char* fragmentSource, bool retrievable,
+    GLuint* vertexID, GLuint* fragmentID)
 {
-    printf("Compiling vertex shader\n");
-    GLuint vertexID = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexID, 1, &vertexSource, NULL);
-    glCompileShader(vertexID);
+    *vertexID = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(*vertexID, 1, &vertexSource, NULL);
+    glCompileShader(*vertexID);
+
+    *fragmentID = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(*fragmentID, 1, &fragmentSource, NULL);
+    glCompileShader(*fragmentID);
+
+    GLuint programID = glCreateProgram();
+    glAttachShader(programID, *vertexID);
+    glAttachShader(programID, *fragmentID);
+    if (retrievable) {
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(programID);
+
+    return programID;
+}
 
+
+/// @brief Prints compile and link errors of program created by `submitProgram`.
+/// Shaders are deleted afterwards, linked program does not need them.
+void checkProgram(GLuint programID, GLuint vertexID, GLuint fragmentID)
+{
     GLint status = false;
     auto checkShader = [&status](GLuint shaderID) {
         glGetShaderiv(shaderID, GL_COMPILE_STATUS, &status);
@@ -22,18 +116,8 @@ GLuint compileShader(const char* vertexSource, const char* fragmentSource)
     };
 
     checkShader(vertexID);
-
-    printf("Compiling fragment shader\n");
-    GLuint fragmentID = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentID, 1, &fragmentSource, NULL);
-    glCompileShader(fragmentID);
     checkShader(fragmentID);
 
-    GLuint programID = glCreateProgram();
-    glAttachShader(programID, vertexID);
-    glAttachShader(programID, fragmentID);
-    glLinkProgram(programID);
-
     glGetProgramiv(programID, GL_LINK_STATUS, &status);
     if (status == GL_FALSE) {
         GLint logLen;
@@ -44,22 +128,229 @@ GLuint compileShader(const char* vertexSource, const char* fragmentSource)
         printf("link error:\n    %s", log.data());
     }
 
+    glDetachShader(programID, vertexID);
+    glDetachShader(programID, fragmentID);
+    glDeleteShader(vertexID);
+    glDeleteShader(fragmentID);
+}
+
+}    // namespace
+
+
+GLuint compileShader(const char* vertexSource, const char* fragmentSource, bool retrievable)
+{
+    printf("Compiling shaders\n");
+
+    GLuint vertexID, fragmentID;
+    GLuint programID = submitProgram(vertexSource, fragmentSource, retrievable, &vertexID,
+        &fragmentID);
+    checkProgram(programID, vertexID, fragmentID);
+
     return programID;
 }
 
 
 ShaderProgram::ShaderProgram(const char* vertexShader, const char* fragmentShader)
 {
-    id = compileShader(vertexShader, fragmentShader);
+    std::string cacheFile = cachePath(vertexShader, fragmentShader);
+
+    cached = !cacheFile.empty() && loadBinary(cacheFile);
+    if (!cached) {
+        id = compileShader(vertexShader, fragmentShader, !cacheFile.empty());
+        reflect();
+
+        if (!cacheFile.empty()) {
+            storeBinary(cacheFile);
+        }
+    }
+
+    oglSetting = nullptr;
+    unsetOGLSetting = nullptr;
+}
+
+
+PendingProgram ShaderProgram::createAsync(const char* vertexShader, const char* fragmentShader)
+{
+    static bool threadsRequested = false;
+    if (!threadsRequested && GLEW_KHR_parallel_shader_compile) {
+        // Let driver choose number of compiler threads
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        threadsRequested = true;
+    }
+
+    PendingProgram pending;
+    pending.program = new ShaderProgram();
+    pending.cacheFile = cachePath(vertexShader, fragmentShader);
+
+    if (!pending.cacheFile.empty() && pending.program->loadBinary(pending.cacheFile)) {
+        pending.program->cached = true;
+        pending.finished = true;
+        return pending;
+    }
+
+    pending.program->id = submitProgram(vertexShader, fragmentShader,
+        !pending.cacheFile.empty(), &pending.vertexID, &pending.fragmentID);
+
+    return pending;
+}
+
+
+ShaderProgram::~ShaderProgram()
+{
+    if (active == this) {
+        active = nullptr;
+    }
+
+    glDeleteProgram(id);
+}
+
+
+PendingProgram::PendingProgram(PendingProgram&& other)
+    : program(other.program), cacheFile(std::move(other.cacheFile)),
+      vertexID(other.vertexID), fragmentID(other.fragmentID), finished(other.finished)
+{
+    other.program = nullptr;
+}
+
+
+PendingProgram& PendingProgram::operator=(PendingProgram&& other)
+{
+    if (this != &other) {
+        delete program;
+        program = other.program;
+        cacheFile = std::move(other.cacheFile);
+        vertexID = other.vertexID;
+        fragmentID = other.fragmentID;
+        finished = other.finished;
+        other.program = nullptr;
+    }
+    return *this;
+}
+
+
+PendingProgram::~PendingProgram()
+{
+    // Completes linking, so shaders are released
+    delete get();
+}
+
+
+bool PendingProgram::ready() const
+{
+    if (program == nullptr || finished) {
+        return true;
+    }
+
+    // Without extension, any query blocks until linking is done
+    if (!GLEW_KHR_parallel_shader_compile) {
+        return true;
+    }
+
+    GLint status;
+    glGetProgramiv(program->id, GL_COMPLETION_STATUS_KHR, &status);
+    return status == GL_TRUE;
+}
+
+
+ShaderProgram* PendingProgram::get()
+{
+    if (program == nullptr) {
+        return nullptr;
+    }
+
+    if (!finished) {
+        checkProgram(program->id, vertexID, fragmentID);
+        program->reflect();
+
+        if (!cacheFile.empty()) {
+            program->storeBinary(cacheFile);
+        }
+        finished = true;
+    }
+
+    ShaderProgram* result = program;
+    program = nullptr;
+    return result;
+}
+
+
+void ShaderProgram::setCacheDirectory(const std::string& directory)
+{
+    cacheDirectory = directory;
+}
+
+
+GLint ShaderProgram::getAttribIndex(std::string name) const
+{
+    std::map<std::string, GLint>::const_iterator it = attribLookup.find(name);
+    return it == attribLookup.end() ? -1 : it->second;
+}
+
+
+void ShaderProgram::bindBlock(const std::string& name, GLuint binding)
+{
+    glUniformBlockBinding(id, getBlockLayout(name).index, binding);
+}
+
+
+const UniformBlockLayout& ShaderProgram::getBlockLayout(const std::string& name) const
+{
+    std::map<std::string, UniformBlockLayout>::const_iterator it = blockLookup.find(name);
+    if (it == blockLookup.end()) {
+        throw std::invalid_argument("Program has no uniform block " + name);
+    }
+
+    return it->second;
+}
+
+
+void ShaderProgram::registerGLSetting(callback_t set, callback_t unset)
+{
+    oglSetting = set;
+    unsetOGLSetting = unset;
+}
+
+
+void ShaderProgram::use() const
+{
+    GLState::useProgram(id);
+
+    if (oglSetting != nullptr) {
+        oglSetting();
+    }
+
+    for (callback_t setter : uniformSetters) {
+        setter();
+    }
+
+    active = this;
+    uploadUniforms();
+}
+
 
+void ShaderProgram::reflect()
+{
     GLint queryResult;
     glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &queryResult);
     this->numAttribs = (unsigned int)queryResult;
 
     GLint maxLength;
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    std::vector<char> attribName(maxLength + 1);
+    GLsizei length;
+
+    for (GLint i = 0; i < queryResult; i++) {
+        GLint size;
+        GLenum type;
+        glGetActiveAttrib(
+            id, i, (GLsizei)attribName.size(), &length, &size, &type, attribName.data());
+
+        std::string name(attribName.data(), length);
+        attribLookup[name] = glGetAttribLocation(id, name.c_str());
+    }
+
     glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
     char* nameBuf = new char[maxLength];
-    GLsizei length;
 
     glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &queryResult);
     for (GLint i = 0; i < queryResult; i++) {
@@ -71,31 +362,258 @@ ShaderProgram::ShaderProgram(const char* vertexShader, const char* fragmentShade
         uniformLookup[name] = std::make_pair(location, i);
     }
 
-    oglSetting = nullptr;
-    unsetOGLSetting = nullptr;
-
     delete[] nameBuf;
+
+    reflectBlocks();
 }
 
 
-void ShaderProgram::registerGLSetting(callback_t set, callback_t unset)
+void ShaderProgram::reflectBlocks()
 {
-    oglSetting = set;
-    unsetOGLSetting = unset;
+    GLint numBlocks;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &numBlocks);
+
+    GLint maxLength;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    std::vector<char> blockName(maxLength + 1);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> memberName(maxLength + 1);
+
+    for (GLint i = 0; i < numBlocks; i++) {
+        GLsizei length;
+        glGetActiveUniformBlockName(id, i, (GLsizei)blockName.size(), &length, blockName.data());
+        std::string block(blockName.data(), length);
+
+        GLint size, numMembers;
+        glGetActiveUniformBlockiv(id, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+        glGetActiveUniformBlockiv(id, i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS, &numMembers);
+
+        std::vector<GLint> indices(numMembers);
+        glGetActiveUniformBlockiv(id, i, GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES, indices.data());
+
+        std::vector<GLuint> members(indices.begin(), indices.end());
+        std::vector<GLint> offsets(numMembers), arrayStrides(numMembers),
+            matrixStrides(numMembers);
+        glGetActiveUniformsiv(id, numMembers, members.data(), GL_UNIFORM_OFFSET, offsets.data());
+        glGetActiveUniformsiv(
+            id, numMembers, members.data(), GL_UNIFORM_ARRAY_STRIDE, arrayStrides.data());
+        glGetActiveUniformsiv(
+            id, numMembers, members.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStrides.data());
+
+        UniformBlockLayout layout {(GLuint)i, (std::size_t)size, {}};
+        for (GLint j = 0; j < numMembers; j++) {
+            GLint arraySize;
+            GLenum type;
+            glGetActiveUniform(id, members[j], (GLsizei)memberName.size(), &length, &arraySize,
+                &type, memberName.data());
+
+            std::string name(memberName.data(), length);
+            // Arrays are reported as "name[0]"
+            if (name.ends_with("[0]")) {
+                name.resize(name.size() - 3);
+            }
+
+            layout.members[name] =
+                BlockMember {type, offsets[j], arraySize, arrayStrides[j], matrixStrides[j]};
+        }
+
+        blockLookup[block] = std::move(layout);
+    }
 }
 
 
-void ShaderProgram::use() const
+bool ShaderProgram::loadBinary(const std::string& path)
 {
-    glUseProgram(id);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
 
-    if (oglSetting != nullptr) {
-        oglSetting();
+    std::uint32_t magic, version, size;
+    GLenum format;
+    if (!readValue(file, &magic) || !readValue(file, &version) || magic != CACHE_MAGIC ||
+        version != CACHE_VERSION || !readValue(file, &format) || !readValue(file, &size) ||
+        !hasBytes(file, size)) {
+        return false;
     }
 
-    for (callback_t setter : uniformSetters) {
-        setter();
+    std::vector<char> binary(size);
+    if (!file.read(binary.data(), size)) {
+        return false;
+    }
+
+    // Tables are read completely before any member is touched
+    std::uint32_t attribs, count;
+    std::map<std::string, GLint> attributes;
+    std::map<std::string, std::pair<GLint, GLuint>> uniforms;
+    std::map<std::string, UniformBlockLayout> blocks;
+    std::string name;
+
+    if (!readValue(file, &attribs) || !readValue(file, &count)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < count; i++) {
+        GLint location;
+        if (!readString(file, &name) || !readValue(file, &location)) {
+            return false;
+        }
+        attributes[name] = location;
+    }
+
+    if (!readValue(file, &count)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < count; i++) {
+        std::pair<GLint, GLuint> uniform;
+        if (!readString(file, &name) || !readValue(file, &uniform.first) ||
+            !readValue(file, &uniform.second)) {
+            return false;
+        }
+        uniforms[name] = uniform;
+    }
+
+    if (!readValue(file, &count)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < count; i++) {
+        UniformBlockLayout layout;
+        std::uint64_t blockSize;
+        std::uint32_t numMembers;
+        if (!readString(file, &name) || !readValue(file, &layout.index) ||
+            !readValue(file, &blockSize) || !readValue(file, &numMembers)) {
+            return false;
+        }
+        layout.size = blockSize;
+
+        for (std::uint32_t j = 0; j < numMembers; j++) {
+            std::string member;
+            BlockMember location;
+            if (!readString(file, &member) || !readValue(file, &location)) {
+                return false;
+            }
+            layout.members[member] = location;
+        }
+        blocks[name] = std::move(layout);
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), size);
+
+    GLint status;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE) {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    id = program;
+    numAttribs = attribs;
+    attribLookup = std::move(attributes);
+    uniformLookup = std::move(uniforms);
+    blockLookup = std::move(blocks);
+
+    return true;
+}
+
+
+void ShaderProgram::storeBinary(const std::string& path) const
+{
+    GLint status, size;
+    glGetProgramiv(id, GL_LINK_STATUS, &status);
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (status == GL_FALSE || size == 0) {
+        return;
+    }
+
+    std::vector<char> binary(size);
+    GLenum format;
+    glGetProgramBinary(id, size, nullptr, &format, binary.data());
+
+    // Written under temporary name, so other processes never read a partial file
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return;
+        }
+
+        writeValue(file, CACHE_MAGIC);
+        writeValue(file, CACHE_VERSION);
+        writeValue(file, format);
+        writeValue(file, (std::uint32_t)size);
+        file.write(binary.data(), size);
+
+        writeValue(file, (std::uint32_t)numAttribs);
+        writeValue(file, (std::uint32_t)attribLookup.size());
+        for (const std::map<std::string, GLint>::value_type& attrib : attribLookup) {
+            writeString(file, attrib.first);
+            writeValue(file, attrib.second);
+        }
+
+        writeValue(file, (std::uint32_t)uniformLookup.size());
+        for (const std::map<std::string, std::pair<GLint, GLuint>>::value_type& uniform :
+            uniformLookup) {
+            writeString(file, uniform.first);
+            writeValue(file, uniform.second.first);
+            writeValue(file, uniform.second.second);
+        }
+
+        writeValue(file, (std::uint32_t)blockLookup.size());
+        for (const std::map<std::string, UniformBlockLayout>::value_type& block : blockLookup) {
+            writeString(file, block.first);
+            writeValue(file, block.second.index);
+            writeValue(file, (std::uint64_t)block.second.size);
+            writeValue(file, (std::uint32_t)block.second.members.size());
+            for (const std::map<std::string, BlockMember>::value_type& member :
+                block.second.members) {
+                writeString(file, member.first);
+                writeValue(file, member.second);
+            }
+        }
+
+        if (!file) {
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tmpPath, path, error);
+}
+
+
+std::string ShaderProgram::cachePath(const char* vertexShader, const char* fragmentShader)
+{
+    if (cacheDirectory.empty() || !(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)) {
+        return "";
+    }
+
+    GLint numFormats;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    if (numFormats == 0) {
+        return "";
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+    if (error) {
+        return "";
+    }
+
+    // Binaries are only valid for the driver which created them
+    const char* parts[4] = {vertexShader, fragmentShader,
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+        reinterpret_cast<const char*>(glGetString(GL_VERSION))};
+
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char* part : parts) {
+        // Terminator separates parts, so moving text between sources changes hash
+        hash = hashBytes(part, std::strlen(part) + 1, hash);
     }
+
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+
+    return (std::filesystem::path(cacheDirectory) / (std::string(name) + ".bin")).string();
 }
 
 
@@ -105,5 +623,77 @@ void ShaderProgram::disable() const
         unsetOGLSetting();
     }
 
-    glUseProgram(0);
+    GLState::useProgram(0);
+    active = nullptr;
+}
+
+
+void ShaderProgram::readUniform(GLint location, GLenum type, void* value) const
+{
+    switch (type) {
+        case GL_FLOAT:
+        case GL_FLOAT_VEC2:
+        case GL_FLOAT_VEC3:
+        case GL_FLOAT_VEC4:
+        case GL_FLOAT_MAT2:
+        case GL_FLOAT_MAT3:
+        case GL_FLOAT_MAT4:
+            glGetUniformfv(id, location, static_cast<GLfloat*>(value));
+            break;
+        case GL_UNSIGNED_INT:
+        case GL_UNSIGNED_INT_VEC2:
+        case GL_UNSIGNED_INT_VEC3:
+        case GL_UNSIGNED_INT_VEC4:
+            glGetUniformuiv(id, location, static_cast<GLuint*>(value));
+            break;
+        default:    // Integers, booleans and samplers
+            glGetUniformiv(id, location, static_cast<GLint*>(value));
+            break;
+    }
+}
+
+
+void ShaderProgram::uploadUniforms() const
+{
+    if (!uniformsDirty) {
+        return;
+    }
+
+    for (UniformSlot& slot : uniformSlots) {
+        if (!slot.dirty) {
+            continue;
+        }
+
+        const GLfloat* f = reinterpret_cast<const GLfloat*>(slot.value.data());
+        const GLint* i = reinterpret_cast<const GLint*>(slot.value.data());
+        const GLuint* u = reinterpret_cast<const GLuint*>(slot.value.data());
+
+        switch (slot.type) {
+            case GL_FLOAT: glUniform1fv(slot.location, slot.count, f); break;
+            case GL_FLOAT_VEC2: glUniform2fv(slot.location, slot.count, f); break;
+            case GL_FLOAT_VEC3: glUniform3fv(slot.location, slot.count, f); break;
+            case GL_FLOAT_VEC4: glUniform4fv(slot.location, slot.count, f); break;
+            case GL_BOOL:
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_BUFFER:
+            case GL_INT: glUniform1iv(slot.location, slot.count, i); break;
+            case GL_BOOL_VEC2:
+            case GL_INT_VEC2: glUniform2iv(slot.location, slot.count, i); break;
+            case GL_BOOL_VEC3:
+            case GL_INT_VEC3: glUniform3iv(slot.location, slot.count, i); break;
+            case GL_BOOL_VEC4:
+            case GL_INT_VEC4: glUniform4iv(slot.location, slot.count, i); break;
+            case GL_UNSIGNED_INT: glUniform1uiv(slot.location, slot.count, u); break;
+            case GL_UNSIGNED_INT_VEC2: glUniform2uiv(slot.location, slot.count, u); break;
+            case GL_UNSIGNED_INT_VEC3: glUniform3uiv(slot.location, slot.count, u); break;
+            case GL_UNSIGNED_INT_VEC4: glUniform4uiv(slot.location, slot.count, u); break;
+            case GL_FLOAT_MAT2: glUniformMatrix2fv(slot.location, slot.count, GL_FALSE, f); break;
+            case GL_FLOAT_MAT3: glUniformMatrix3fv(slot.location, slot.count, GL_FALSE, f); break;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(slot.location, slot.count, GL_FALSE, f); break;
+        }
+
+        slot.dirty = false;
+    }
+
+    uniformsDirty = false;
 }
@@ -2,24 +2,56 @@
 
 #include <GL/Glew.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <glm/glm.hpp>
 #include <map>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "uniform_buffer.h"
 
 
 /// @brief Compiles and links vertex and fragment shaders.
 /// @param vertexSource, fragmentSource null terminated string containing shader code.
+/// @param retrievable Hints that program binary will be queried with `glGetProgramBinary`.
 /// @return shader program id.
-GLuint compileShader(const char* vertexSource, const char* fragmentSource);
+GLuint compileShader(
+    const char* vertexSource, const char* fragmentSource, bool retrievable = false);
+
+template<typename T> class UniformHandle;
+class PendingProgram;
+
 
 /// Provides simplified access to OGL shader API.
 class ShaderProgram {
   public:
     using callback_t = std::function<void()>;
 
+    /// @brief Compiles program or loads it from program cache, see `setCacheDirectory`.
     /// @param vertexShader, fragmentShader null terminated string containing shader code.
     ShaderProgram(const char* vertexShader, const char* fragmentShader);
+    ~ShaderProgram();
+
+    ShaderProgram(const ShaderProgram&) = delete;
+    ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+    /// @brief Enables on disk cache of linked program binaries and their reflected attributes,
+    /// uniforms and uniform blocks.
+    /// Entries are keyed by a hash of both sources, `GL_RENDERER` and `GL_VERSION`. Programs whose
+    /// binary is rejected by the driver, e.g. after a driver update, are compiled from source and
+    /// stored again. Has no effect without `GL_ARB_get_program_binary`.
+    /// @param directory Created if missing. Empty string disables cache (default).
+    static void setCacheDirectory(const std::string& directory);
+
+    /// @brief Starts compiling and linking program without waiting for the driver.
+    /// Submitting all programs before finishing any of them lets drivers supporting
+    /// `GL_KHR_parallel_shader_compile` build them on several threads. Programs found in the
+    /// program cache are ready immediately.
+    static PendingProgram createAsync(const char* vertexShader, const char* fragmentShader);
 
     /// @brief Binds a non-matrix uniform to a value.
     /// Creates a binding between @p values and uniform assigned to @name. If possible values are
@@ -36,7 +68,23 @@ class ShaderProgram {
     /// @endcode values are transferred to uniform in transposed order.
     void bindUniform(
         std::string name, GLboolean transpose, const GLfloat* values, GLsizei count = 1);
+    /// @brief Returns handle writing uniform @p name through the program's value cache.
+    /// Name and type are resolved once. Values written through the handle are compared against
+    /// the cache and only uploaded when changed, either immediately if the program is in use or
+    /// on next `use`.
+    /// @throws std::invalid_argument if program has no uniform @p name outside of a uniform block,
+    /// or if its type does not match @p T .
+    template<typename T> UniformHandle<T> uniform(const std::string& name);
+    /// @brief Registers callbacks run by `use` and `disable`.
+    /// State should be changed through `GLState`, so callbacks run every frame cost nothing when
+    /// state is already set.
     void registerGLSetting(callback_t set, callback_t unset = nullptr);
+    /// @brief Reads uniform block @p name from buffers attached to binding point @p binding.
+    /// Blocks of different programs bound to the same point share one `UniformBuffer`, which is
+    /// only uploaded when its content changed and not on `use`.
+    void bindBlock(const std::string& name, GLuint binding);
+    /// @brief Returns reflected size and member offsets of uniform block @p name.
+    const UniformBlockLayout& getBlockLayout(const std::string& name) const;
     /// Binds shader to ogl context and sets uniforms to bound values.
     void use() const;
     /// Unbinds shader from ogl context.
@@ -44,18 +92,115 @@ class ShaderProgram {
 
     /// @brief Returns index of vertex attribute.
     /// @param name of vertex attribute.
-    GLint getAttribIndex(std::string name) const { return glGetAttribLocation(id, name.c_str()); };
+    GLint getAttribIndex(std::string name) const;
     /// Returns number of vertex attributes.
     unsigned int getNumAttribs() const { return numAttribs; };
+    /// Returns whether program was loaded from program cache instead of compiled from source.
+    bool fromCache() const { return cached; }
 
   private:
+    template<typename T> friend class UniformHandle;
+    friend class PendingProgram;
+    friend class CommandList;
+
+    /// Creates program without GL object, filled in by `createAsync`.
+    ShaderProgram() : id(0), numAttribs(0), oglSetting(nullptr), unsetOGLSetting(nullptr) {}
+
+    /// Cached value of a uniform written through an `UniformHandle`.
+    struct UniformSlot {
+        GLint location;
+        GLenum type;
+        GLsizei count;
+        std::vector<std::uint8_t> value;
+        bool dirty;
+    };
+
+    /// Fills attribute, uniform and block tables of linked program.
+    void reflect();
+    /// Fills `blockLookup` with layouts of all active uniform blocks.
+    void reflectBlocks();
+    /// @brief Creates program from cached binary and reflection tables.
+    /// @return false if file is missing or damaged or binary is rejected by driver.
+    bool loadBinary(const std::string& path);
+    void storeBinary(const std::string& path) const;
+    /// Returns cache file of program, empty if caching is disabled or not supported.
+    static std::string cachePath(const char* vertexShader, const char* fragmentShader);
+    /// Reads current value of uniform at @p location into @p value, components as for @p type.
+    void readUniform(GLint location, GLenum type, void* value) const;
+    /// Copies @p size bytes to cache of slot, marks it dirty if content changed.
+    void writeUniform(std::size_t slot, const void* values, std::size_t size);
+    /// Sends dirty cached values to GL, program must be in use.
+    void uploadUniforms() const;
+
     GLuint id;
     unsigned int numAttribs;
     std::vector<callback_t> uniformSetters;
     callback_t oglSetting;
     callback_t unsetOGLSetting;
+    std::map<std::string, GLint> attribLookup;
     std::map<std::string, std::pair<GLint, GLuint>>
         uniformLookup;    // Maps name to (location, index)
+    std::map<std::string, UniformBlockLayout> blockLookup;
+    mutable std::vector<UniformSlot> uniformSlots;
+    std::map<std::string, std::size_t> slotLookup;
+    mutable bool uniformsDirty = false;
+    bool cached = false;
+
+    /// Program of last `use`, null after `disable`.
+    static const ShaderProgram* active;
+    static std::string cacheDirectory;
+};
+
+
+/// @brief Program being compiled in the background, returned by `ShaderProgram::createAsync`.
+class PendingProgram {
+  public:
+    PendingProgram(PendingProgram&& other);
+    PendingProgram& operator=(PendingProgram&& other);
+    ~PendingProgram();
+
+    /// @brief Returns whether `get` can return without waiting for the driver.
+    /// Polls `GL_COMPLETION_STATUS_KHR`, always true if extension is not supported.
+    bool ready() const;
+
+    /// @brief Checks link status, reflects program and stores it in program cache.
+    /// Blocks if program is not ready yet.
+    /// @return Program owned by caller, null if already returned before.
+    ShaderProgram* get();
+
+  private:
+    friend class ShaderProgram;
+
+    PendingProgram() = default;
+
+    ShaderProgram* program = nullptr;
+    std::string cacheFile;
+    GLuint vertexID = 0;
+    GLuint fragmentID = 0;
+    bool finished = false;
+};
+
+
+/// @brief Typed reference to a uniform of a `ShaderProgram`, created by `ShaderProgram::uniform`.
+/// Writes go to the program's value cache, unchanged values are never uploaded again.
+template<typename T> class UniformHandle {
+  public:
+    UniformHandle() = default;
+
+    void set(const T& value) { set(&value, 1); }
+    /// @brief Writes first @p count elements of uniform array.
+    void set(const T* values, GLsizei count);
+
+    bool valid() const { return program != nullptr; }
+
+  private:
+    friend class ShaderProgram;
+    friend class CommandList;
+
+    UniformHandle(ShaderProgram* program, std::size_t slot) : program(program), slot(slot) {}
+
+    ShaderProgram* program = nullptr;
+    std::size_t slot = 0;
 };
 
 
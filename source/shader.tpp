@@ -15,10 +15,12 @@ static ShaderProgram::callback_t uniformCallback(
 
     switch (type) {
         case GL_SAMPLER_2D:
+        case GL_SAMPLER_BUFFER:
         case GL_INT: callback = glUniform1iv; break;
         case GL_INT_VEC2: callback = glUniform2iv; break;
         case GL_INT_VEC3: callback = glUniform3iv; break;
         case GL_INT_VEC4: callback = glUniform4iv; break;
+        default: throw std::invalid_argument("Uniform type does not match GLint");
     }
 
     // TODO: perform type casting/checking
@@ -36,12 +38,13 @@ static ShaderProgram::callback_t uniformCallback(
         case GL_FLOAT: callback = glUniform1fv; break;
         case GL_FLOAT_VEC2: callback = glUniform2fv; break;
         case GL_FLOAT_VEC3: callback = glUniform3fv; break;
-        case GL_FLOAT_VEC4: callback = glUniform4fv;
+        case GL_FLOAT_VEC4: callback = glUniform4fv; break;
+        default: throw std::invalid_argument("Uniform type does not match GLfloat");
     }
 
     // TODO: perform type casting/checking
 
-    return [=]() { calback(location, count, values); };
+    return [=]() { callback(location, count, values); };
 }
 
 template<UIntConvertable T>
@@ -58,12 +61,13 @@ static ShaderProgram::callback_t uniformCallback(
         case GL_BOOL_VEC3:
         case GL_UNSIGNED_INT_VEC3: callback = glUniform3uiv; break;
         case GL_BOOL_VEC4:
-        case GL_UNSIGNED_INT_VEC4: callback = glUniform4uiv;
+        case GL_UNSIGNED_INT_VEC4: callback = glUniform4uiv; break;
+        default: throw std::invalid_argument("Uniform type does not match GLuint");
     }
 
     // TODO: perform type casting/checking
 
-    return [=]() { calback(location, count, values); };
+    return [=]() { callback(location, count, values); };
 }
 
 static ShaderProgram::callback_t uniformMatrixCallback(
@@ -81,6 +85,7 @@ static ShaderProgram::callback_t uniformMatrixCallback(
         case GL_FLOAT_MAT4x2: callback = glUniformMatrix4x2fv; break;
         case GL_FLOAT_MAT4x3: callback = glUniformMatrix4x3fv; break;
         case GL_FLOAT_MAT4: callback = glUniformMatrix4fv; break;
+        default: throw std::invalid_argument("Uniform type is not a matrix");
     }
 
     // TODO: perform type checking/casting
@@ -88,6 +93,60 @@ static ShaderProgram::callback_t uniformMatrixCallback(
     return [=]() { callback(location, count, transpose, values); };
 }
 
+/// @brief Returns whether values of type @p T can be uploaded to uniforms of GL type @p type.
+template<typename T> constexpr bool uniformTypeMatches(GLenum type)
+{
+    if constexpr (std::is_same<T, GLfloat>::value) {
+        return type == GL_FLOAT;
+    }
+    else if constexpr (std::is_same<T, glm::vec2>::value) {
+        return type == GL_FLOAT_VEC2;
+    }
+    else if constexpr (std::is_same<T, glm::vec3>::value) {
+        return type == GL_FLOAT_VEC3;
+    }
+    else if constexpr (std::is_same<T, glm::vec4>::value) {
+        return type == GL_FLOAT_VEC4;
+    }
+    else if constexpr (std::is_same<T, GLint>::value) {
+        return type == GL_INT || type == GL_BOOL || type == GL_SAMPLER_2D ||
+               type == GL_SAMPLER_BUFFER;
+    }
+    else if constexpr (std::is_same<T, glm::ivec2>::value) {
+        return type == GL_INT_VEC2 || type == GL_BOOL_VEC2;
+    }
+    else if constexpr (std::is_same<T, glm::ivec3>::value) {
+        return type == GL_INT_VEC3 || type == GL_BOOL_VEC3;
+    }
+    else if constexpr (std::is_same<T, glm::ivec4>::value) {
+        return type == GL_INT_VEC4 || type == GL_BOOL_VEC4;
+    }
+    else if constexpr (std::is_same<T, GLuint>::value) {
+        return type == GL_UNSIGNED_INT;
+    }
+    else if constexpr (std::is_same<T, glm::uvec2>::value) {
+        return type == GL_UNSIGNED_INT_VEC2;
+    }
+    else if constexpr (std::is_same<T, glm::uvec3>::value) {
+        return type == GL_UNSIGNED_INT_VEC3;
+    }
+    else if constexpr (std::is_same<T, glm::uvec4>::value) {
+        return type == GL_UNSIGNED_INT_VEC4;
+    }
+    else if constexpr (std::is_same<T, glm::mat2>::value) {
+        return type == GL_FLOAT_MAT2;
+    }
+    else if constexpr (std::is_same<T, glm::mat3>::value) {
+        return type == GL_FLOAT_MAT3;
+    }
+    else if constexpr (std::is_same<T, glm::mat4>::value) {
+        return type == GL_FLOAT_MAT4;
+    }
+    else {
+        return false;
+    }
+}
+
 }    // namespace
 
 
@@ -118,4 +177,78 @@ inline void ShaderProgram::bindUniform(
     callback_t callback = uniformMatrixCallback(location, type, values, count, transpose);
 
     uniformSetters.push_back(callback);
+}
+
+
+template<typename T> inline UniformHandle<T> ShaderProgram::uniform(const std::string& name)
+{
+    std::map<std::string, std::size_t>::const_iterator cached = slotLookup.find(name);
+    if (cached != slotLookup.end()) {
+        if (!uniformTypeMatches<T>(uniformSlots[cached->second].type)) {
+            throw std::invalid_argument("Type does not match uniform " + name);
+        }
+        return UniformHandle<T>(this, cached->second);
+    }
+
+    // Arrays are reflected as "name[0]"
+    std::map<std::string, std::pair<GLint, GLuint>>::const_iterator it = uniformLookup.find(name);
+    if (it == uniformLookup.end()) {
+        it = uniformLookup.find(name + "[0]");
+    }
+    // Members of uniform blocks have no location
+    if (it == uniformLookup.end() || it->second.first == -1) {
+        throw std::invalid_argument("Program has no uniform " + name);
+    }
+
+    GLint count;
+    GLenum type;
+    glGetActiveUniform(id, it->second.second, 0, nullptr, &count, &type, nullptr);
+    if (!uniformTypeMatches<T>(type)) {
+        throw std::invalid_argument("Type does not match uniform " + name);
+    }
+
+    // Initialisers and sampler bindings in the shader can make linked values non-zero. Elements
+    // of arrays are read by their own location, which need not be consecutive.
+    std::vector<std::uint8_t> value(count * sizeof(T), 0);
+    readUniform(it->second.first, type, value.data());
+    for (GLint i = 1; i < count; i++) {
+        // Reflected name of arrays ends with "[0]"
+        std::string element = it->first.substr(0, it->first.size() - 3) + "[" +
+                               std::to_string(i) + "]";
+        GLint location = glGetUniformLocation(id, element.c_str());
+        if (location != -1) {
+            readUniform(location, type, value.data() + i * sizeof(T));
+        }
+    }
+    uniformSlots.push_back({it->second.first, type, count, std::move(value), false});
+    slotLookup[name] = uniformSlots.size() - 1;
+
+    return UniformHandle<T>(this, uniformSlots.size() - 1);
+}
+
+
+inline void ShaderProgram::writeUniform(std::size_t slot, const void* values, std::size_t size)
+{
+    UniformSlot& cache = uniformSlots[slot];
+    if (size > cache.value.size()) {
+        throw std::length_error("Write exceeds uniform array");
+    }
+
+    if (std::memcmp(cache.value.data(), values, size) == 0) {
+        return;
+    }
+
+    std::memcpy(cache.value.data(), values, size);
+    cache.dirty = true;
+    uniformsDirty = true;
+
+    if (active == this) {
+        uploadUniforms();
+    }
+}
+
+
+template<typename T> inline void UniformHandle<T>::set(const T* values, GLsizei count)
+{
+    program->writeUniform(slot, values, count * sizeof(T));
 }
\ No newline at end of file
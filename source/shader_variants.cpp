@@ -0,0 +1,170 @@
+#include "shader_variants.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+
+namespace {
+
+/// Returns whether @p line is an include directive and stores quoted path in @p path.
+bool parseInclude(const std::string& line, std::string* path)
+{
+    std::size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+        return false;
+    }
+
+    std::size_t open = line.find('"', start + 8);
+    std::size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+    if (close == std::string::npos) {
+        return false;
+    }
+
+    *path = line.substr(open + 1, close - open - 1);
+    return true;
+}
+
+
+/// Appends content of @p path to @p out, recursively resolving includes.
+/// @param files Maps normalized paths of files included so far to their source number.
+void appendFile(const std::filesystem::path& path, std::map<std::string, int>* files,
+    std::string* out)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open shader file " + path.string());
+    }
+
+    int index = (int)files->size();
+    (*files)[std::filesystem::weakly_canonical(path).string()] = index;
+
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+
+        std::string included;
+        if (!parseInclude(line, &included)) {
+            *out += line + "\n";
+            continue;
+        }
+
+        std::filesystem::path target = path.parent_path() / included;
+        if (files->contains(std::filesystem::weakly_canonical(target).string())) {
+            // Keeps line numbers of following lines
+            *out += "\n";
+            continue;
+        }
+
+        *out += "#line 1 " + std::to_string(files->size()) + "\n";
+        appendFile(target, files, out);
+        *out += "#line " + std::to_string(number + 1) + " " + std::to_string(index) + "\n";
+    }
+}
+
+}    // namespace
+
+
+std::string resolveIncludes(const std::string& path)
+{
+    std::map<std::string, int> files;
+    std::string source;
+    appendFile(path, &files, &source);
+
+    return source;
+}
+
+
+std::string injectDefines(
+    const std::string& source, const std::map<std::string, std::string>& defines)
+{
+    // #version has to precede everything else
+    std::size_t pos = 0;
+    std::size_t version = source.find("#version");
+    if (version != std::string::npos) {
+        std::size_t end = source.find('\n', version);
+        pos = end == std::string::npos ? source.size() : end + 1;
+    }
+
+    std::string block;
+    for (const std::map<std::string, std::string>::value_type& define : defines) {
+        block += "#define " + define.first;
+        if (!define.second.empty()) {
+            block += " " + define.second;
+        }
+        block += "\n";
+    }
+
+    std::size_t nextLine = 1;
+    for (std::size_t i = 0; i < pos; i++) {
+        nextLine += source[i] == '\n';
+    }
+    block += "#line " + std::to_string(nextLine) + " 0\n";
+
+    return source.substr(0, pos) + block + source.substr(pos);
+}
+
+
+ShaderVariants::ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath,
+    const std::vector<std::string>& options, const std::map<std::string, std::string>& defines)
+    : vertexSource(resolveIncludes(vertexPath)), fragmentSource(resolveIncludes(fragmentPath)),
+      options(options), defines(defines)
+{
+    if (options.size() > 32) {
+        throw std::length_error("Shader variants support at most 32 options");
+    }
+}
+
+
+ShaderVariants::~ShaderVariants()
+{
+    for (std::map<std::uint32_t, ShaderProgram*>::value_type& program : programs) {
+        delete program.second;
+    }
+}
+
+
+std::uint32_t ShaderVariants::bit(const std::string& option) const
+{
+    for (std::size_t i = 0; i < options.size(); i++) {
+        if (options[i] == option) {
+            return std::uint32_t(1) << i;
+        }
+    }
+
+    throw std::invalid_argument("Undeclared shader option " + option);
+}
+
+
+ShaderProgram* ShaderVariants::get(std::uint32_t mask)
+{
+    std::map<std::uint32_t, ShaderProgram*>::iterator it = programs.find(mask);
+    if (it != programs.end()) {
+        return it->second;
+    }
+
+    if (options.size() < 32 && (mask >> options.size()) != 0) {
+        throw std::invalid_argument("Variant mask selects undeclared shader options");
+    }
+
+    std::map<std::string, std::string> variantDefines = defines;
+    for (std::size_t i = 0; i < options.size(); i++) {
+        if (mask & (std::uint32_t(1) << i)) {
+            variantDefines[options[i]] = "";
+        }
+    }
+
+    ShaderProgram* program = new ShaderProgram(injectDefines(vertexSource, variantDefines).c_str(),
+        injectDefines(fragmentSource, variantDefines).c_str());
+    programs[mask] = program;
+
+    return program;
+}
\ No newline at end of file
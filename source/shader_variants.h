@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "shader.h"
+
+
+/// @brief Reads shader file and replaces `#include "file"` lines by content of file.
+/// Paths are relative to including file. Each file is included at most once, so include cycles
+/// end. `#line` directives keep line numbers of compile errors, files are numbered in order of
+/// first inclusion starting with 0.
+/// @throws std::runtime_error if a file can not be read.
+std::string resolveIncludes(const std::string& path);
+
+/// @brief Inserts `#define` lines after `#version` line of @p source.
+/// @param defines Maps macro names to values, empty values define macro without value.
+std::string injectDefines(
+    const std::string& source, const std::map<std::string, std::string>& defines);
+
+
+/// @brief Lazily compiled variants of a vertex and fragment shader pair.
+/// Each variant defines a subset of declared options as macros, selected by a bitmask with bit
+/// `i` set for `options[i]`. Shaders branch with `#ifdef` at compile time instead of on uniforms
+/// at run time. Includes are resolved once, variants are compiled on first request and kept.
+class ShaderVariants {
+  public:
+    /// @param options Names of macros spanning permutation space, at most 32.
+    /// @param defines Macros defined in every variant.
+    ShaderVariants(const std::string& vertexPath, const std::string& fragmentPath,
+        const std::vector<std::string>& options,
+        const std::map<std::string, std::string>& defines = {});
+    ~ShaderVariants();
+
+    ShaderVariants(const ShaderVariants&) = delete;
+    ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+    /// @brief Returns bitmask selecting @p option.
+    /// @throws std::invalid_argument if option was not declared.
+    std::uint32_t bit(const std::string& option) const;
+
+    /// @brief Returns program of variant @p mask, compiling it on first request.
+    /// @throws std::invalid_argument if @p mask selects undeclared options.
+    ShaderProgram* get(std::uint32_t mask);
+
+    /// @brief Returns number of variants compiled so far.
+    std::size_t numCompiled() const { return programs.size(); }
+
+  private:
+    std::string vertexSource;
+    std::string fragmentSource;
+    std::vector<std::string> options;
+    std::map<std::string, std::string> defines;
+    std::map<std::uint32_t, ShaderProgram*> programs;
+};
\ No newline at end of file
@@ -4,117 +4,378 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-#include <cstring>
-#include <utility>
+#include <cstddef>
 #include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
 
+#include "convert.h"
+#include "face_registry.h"
+
+void decodeUtf8(const char* text, std::vector<char32_t>* codePoints)
+{
+    constexpr char32_t REPLACEMENT = 0xFFFD;
+
+    codePoints->clear();
+    const unsigned char* it = reinterpret_cast<const unsigned char*>(text);
+
+    while (*it != 0) {
+        unsigned char lead = *it++;
+        if (lead < 0x80) {
+            codePoints->push_back(lead);
+            continue;
+        }
+
+        int numContinuation;
+        char32_t c;
+        char32_t min;
+        if ((lead & 0xE0) == 0xC0) {
+            numContinuation = 1;
+            c = lead & 0x1F;
+            min = 0x80;
+        }
+        else if ((lead & 0xF0) == 0xE0) {
+            numContinuation = 2;
+            c = lead & 0x0F;
+            min = 0x800;
+        }
+        else if ((lead & 0xF8) == 0xF0) {
+            numContinuation = 3;
+            c = lead & 0x07;
+            min = 0x10000;
+        }
+        else {    // Stray continuation byte or invalid lead byte
+            codePoints->push_back(REPLACEMENT);
+            continue;
+        }
+
+        int i = 0;
+        for (; i < numContinuation && (*it & 0xC0) == 0x80; i++) {
+            c = (c << 6) | (*it++ & 0x3F);
+        }
+
+        // Truncated, overlong, surrogate or out of range
+        if (i < numContinuation || c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+            c = REPLACEMENT;
+        }
+        codePoints->push_back(c);
+    }
+}
 
-TextRender::FaceCache TextRender::_cache = TextRender::FaceCache();
+
+GlyphTable::GlyphTable() : slots(16, Slot {EMPTY, {}})
+{
+}
 
 
-GLuint generateTexture(char c, FT_Bitmap* bitmap)
+const Character* GlyphTable::find(char32_t c) const
 {
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (c < DIRECT_SIZE) {
+        return present[c] ? &direct[c] : nullptr;
+    }
 
-    GLuint texture;
-    glGenTextures(1, &texture);
+    const Slot& slot = slots[slotIndex(c)];
+    return slot.key == c ? &slot.value : nullptr;
+}
 
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D,
-        0,
-        GL_RED,
-        bitmap->width,
-        bitmap->rows,
-        0,
-        GL_RED,
-        GL_UNSIGNED_BYTE,
-        (void*)bitmap->buffer);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+void GlyphTable::insert(char32_t c, const Character& character)
+{
+    if (c < DIRECT_SIZE) {
+        numDirect += present[c] ? 0 : 1;
+        present[c] = true;
+        direct[c] = character;
+        return;
+    }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Keep load factor below 1/2, probe sequences stay short
+    if (2 * (numHashed + 1) > slots.size()) {
+        grow();
+    }
 
-    return texture;
+    Slot& slot = slots[slotIndex(c)];
+    if (slot.key == EMPTY) {
+        numHashed++;
+    }
+    slot = {c, character};
 }
 
 
-TextRender::TextRender(
-    const char* fpath, signed long idx)
+std::size_t GlyphTable::slotIndex(char32_t c) const
 {
-    if (FT_Init_FreeType(&library)) {
-        throw std::runtime_error("Could not load FreeType2");
+    std::size_t mask = slots.size() - 1;
+    std::size_t idx = (c * 0x9E3779B1u) & mask;    // Sequential code points get distinct slots
+
+    while (slots[idx].key != c && slots[idx].key != EMPTY) {
+        idx = (idx + 1) & mask;
     }
 
-    if (FT_New_Face(library, fpath, idx, &face)) {
-        throw std::runtime_error("Could not load face " + std::string(fpath));
+    return idx;
+}
+
+
+void GlyphTable::grow()
+{
+    std::vector<Slot> old(2 * slots.size(), Slot {EMPTY, {}});
+    old.swap(slots);
+
+    for (const Slot& slot : old) {
+        if (slot.key != EMPTY) {
+            slots[slotIndex(slot.key)] = slot;
+        }
     }
+}
+
 
-    FT_Set_Pixel_Sizes(face, 0, 48);
+TextRender::FaceCache TextRender::_cache = TextRender::FaceCache();
+GlyphAtlas* TextRender::_atlas = nullptr;
+unsigned int TextRender::numInstances = 0;
+std::size_t TextRender::_generation = 0;
 
-    FaceID faceId = std::make_pair(fpath, idx);
+
+TextRender::TextRender(
+    const char* fpath, signed long idx, GlyphMode mode)
+    : mode(mode), path(fpath), faceIndex(idx)
+{
+    face = FaceRegistry::acquire(
+        fpath, idx, mode == GlyphMode::SDF ? SDF_PIXEL_SIZE : BITMAP_PIXEL_SIZE);
+
+    FaceID faceId = std::make_tuple(fpath, idx, mode);
     if (!_cache.contains(faceId)) {
         _cache[faceId] = CharCache();
     }
 
     cache = &_cache[faceId];
+
+    if (numInstances++ == 0) {
+        _atlas = new GlyphAtlas();
+    }
+}
+
+
+TextRender::~TextRender()
+{
+    delete rasterizer;
+    FaceRegistry::release(face);
+
+    // Cached glyphs refer to atlas regions, both are dropped together
+    if (--numInstances == 0) {
+        delete _atlas;
+        _atlas = nullptr;
+        _cache.clear();
+    }
 }
 
 
 void TextRender::add(const char* text, float x1, float y1, float x2, float y2)
+{
+    layout(text, x1, y1, x2, y2, &glyphs);
+}
+
+
+bool TextRender::layout(const char* text, float x1, float y1, float x2, float y2,
+    glyph_map_t* glyphs, bool wait)
 {
     unsigned int totalWidth = 0;
     unsigned int maxHeight = 0;
     int maxBearingY = 0;
-    unsigned int n = strlen(text);
+    bool complete = true;
 
-    for (int i = 0; i < n; i++) {
-        char c = text[i];
-        Character current;
-        if (cache->contains(c)) {
-            current = (*cache)[c];
-        }
-        else if (!FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            current = {generateTexture(text[i], &face->glyph->bitmap), face->glyph->bitmap.width,
-                face->glyph->bitmap.rows, face->glyph->bitmap_left, face->glyph->bitmap_top,
-                face->glyph->advance.x >> 6};
+    decodeUtf8(text, &codePoints);
+
+    if (rasterizer != nullptr) {
+        awaitGlyphs(wait);
+    }
 
-            (*cache)[c] = current;
+    for (char32_t c : codePoints) {
+        const Character* current = cache->find(c);
+        if (current == nullptr && rasterizer != nullptr) {
+            current = &placeholder;
+            complete = false;
         }
-        else {
-            throw std::runtime_error("Could not load char " + c);
+        else if (current == nullptr) {
+            cache->insert(c, loadChar(c));
+            current = cache->find(c);
         }
 
-        totalWidth += current.advanceX;
-        if (current.height > maxHeight) {
-            maxHeight = current.height;
-            maxBearingY = current.bearingY;
+        totalWidth += current->advanceX;
+        if (current->height > maxHeight) {
+            maxHeight = current->height;
+            maxBearingY = current->bearingY;
         }
     }
 
+    if (maxHeight == 0) {    // Nothing visible
+        return complete;
+    }
+
     float boxWidth = x2 - x1;
     float boxHeight = y2 - y1;
     float cursorY = y2 - (boxHeight * maxBearingY / maxHeight);
 
-    for (int i = 0; i < n; i++) {
-        Character* current = &(*cache)[text[i]];
+    // Consecutive glyphs mostly share a page, avoid map lookup per glyph
+    unsigned int lastPage = 0;
+    std::vector<Glyph>* pageGlyphs = nullptr;
+
+    for (char32_t c : codePoints) {
+        const Character* current = cache->find(c);
+        if (current == nullptr) {
+            current = &placeholder;
+        }
+
         float relWidth = boxWidth * current->width / totalWidth;
         float relHeight = boxHeight * current->height / maxHeight;
         float relBearingX = relWidth * current->bearingX / current->width;
         float relBearingY = relHeight * current->bearingY / current->height;
         float relNegBearingY = relHeight - relBearingY;
 
-        glyphs[current->texture].emplace_back(
-            x1 + relBearingX,
-            x1 + relWidth + relBearingX,
-            cursorY - relNegBearingY,
-            cursorY + relBearingY
-        );
+        // Glyphs without bitmap (e.g. whitespace) only advance cursor
+        if (current->width > 0 && current->height > 0) {
+            if (pageGlyphs == nullptr || current->page != lastPage) {
+                lastPage = current->page;
+                pageGlyphs = &(*glyphs)[_atlas->texture(lastPage)];
+            }
+
+            pageGlyphs->push_back({
+                Rectangle<float>(
+                    x1 + relBearingX,
+                    x1 + relWidth + relBearingX,
+                    cursorY - relNegBearingY,
+                    cursorY + relBearingY
+                ),
+                Rectangle<float>(current->u1, current->u2, current->v1, current->v2),
+                current->index
+            });
+        }
 
         x1 += boxWidth * current->advanceX / totalWidth;
     }
+
+    return complete;
+}
+
+
+Character TextRender::loadChar(char32_t c)
+{
+    rasterizeGlyph(face, c, mode);
+
+    FT_Bitmap* bitmap = &face->glyph->bitmap;
+    if (bitmap->pitch < 0) {
+        // Stored bottom up, atlas expects top row first
+        std::vector<unsigned char> pixels;
+        copyRows(bitmap, &pixels);
+        return storeGlyph(pixels.data(), bitmap->width, bitmap->rows, bitmap->width,
+            face->glyph->bitmap_left, face->glyph->bitmap_top, face->glyph->advance.x >> 6);
+    }
+
+    return storeGlyph(bitmap->buffer, bitmap->width, bitmap->rows, bitmap->pitch,
+        face->glyph->bitmap_left, face->glyph->bitmap_top, face->glyph->advance.x >> 6);
+}
+
+
+Character TextRender::storeGlyph(const unsigned char* pixels, unsigned int width,
+    unsigned int height, unsigned int pitch, int bearingX, int bearingY, long int advanceX)
+{
+    AtlasRegion region = _atlas->insert(pixels, width, height, pitch);
+    _generation++;
+    float pageSize = _atlas->pageSize();
+
+    return {region.page, region.index, region.x / pageSize, region.y / pageSize,
+        (region.x + region.width) / pageSize, (region.y + region.height) / pageSize, width, height,
+        bearingX, bearingY, advanceX};
+}
+
+
+void TextRender::rasterizeInBackground(
+    unsigned int numThreads, MissPolicy policy, std::chrono::microseconds maxWait)
+{
+    unsigned int pixelSize = mode == GlyphMode::SDF ? SDF_PIXEL_SIZE : BITMAP_PIXEL_SIZE;
+
+    delete rasterizer;
+    rasterizer = new GlyphRasterizer(path, faceIndex, pixelSize, mode, numThreads);
+    this->policy = policy;
+    this->maxWait = maxWait;
+
+    // Advances cursor like an average glyph, draws nothing
+    placeholder = {0, 0, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0, 0, 0, (long int)pixelSize / 2};
+}
+
+
+void TextRender::prewarm(const char* charset)
+{
+    decodeUtf8(charset, &codePoints);
+
+    if (rasterizer == nullptr) {
+        for (char32_t c : codePoints) {
+            if (cache->find(c) == nullptr) {
+                cache->insert(c, loadChar(c));
+            }
+        }
+        return;
+    }
+
+    for (char32_t c : codePoints) {
+        if (cache->find(c) == nullptr) {
+            rasterizer->request(c);
+        }
+    }
+
+    while (rasterizer->numPending() > 0) {
+        rasterizer->waitUntil(std::chrono::steady_clock::now() + std::chrono::seconds(1));
+        uploadGlyphs();
+    }
+}
+
+
+std::size_t TextRender::uploadGlyphs()
+{
+    if (rasterizer == nullptr || rasterizer->collect(&finished) == 0) {
+        return 0;
+    }
+
+    std::size_t n = finished.size();
+    for (const GlyphBitmap& glyph : finished) {
+        if (cache->find(glyph.code) == nullptr) {
+            cache->insert(glyph.code, storeGlyph(glyph.pixels.data(), glyph.width, glyph.height,
+                glyph.width, glyph.bearingX, glyph.bearingY, glyph.advanceX));
+        }
+    }
+
+    finished.clear();
+
+    return n;
+}
+
+
+void TextRender::awaitGlyphs(bool wait)
+{
+    uploadGlyphs();
+
+    bool missing = false;
+    for (char32_t c : codePoints) {
+        if (cache->find(c) == nullptr) {
+            rasterizer->request(c);
+            missing = true;
+        }
+    }
+
+    if (!missing || !wait || policy == MissPolicy::Placeholder) {
+        return;
+    }
+
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + maxWait;
+    while (missing && rasterizer->waitUntil(deadline)) {
+        uploadGlyphs();
+
+        missing = false;
+        for (char32_t c : codePoints) {
+            if (cache->find(c) == nullptr) {
+                missing = true;
+                break;
+            }
+        }
+    }
 }
 
 
@@ -127,37 +388,63 @@ void TextRender::clear()
 unsigned int TextRender::draw(const AttributeBinding* position,
     const AttributeBinding* uv,
     GLuint* textures,
-    unsigned int* offsets)
+    unsigned int* offsets,
+    unsigned int first)
 {
+    std::size_t numGlyphs = 0;
+    for (const glyph_map_t::value_type& v : glyphs) {
+        numGlyphs += v.second.size();
+    }
+
     std::size_t idx = 0;
-    unsigned int offset = position->buffer->size() / position->stride;
-    float data[24];
-    for (glyph_map_t::value_type v : glyphs) {
+    unsigned int offset = first == APPEND ? position->buffer->size() / position->stride : first;
+
+    // Both reservations require same buffer size, second one does not invalidate first
+    VertexView<float> positions = VAO::reserve<float>(position, numGlyphs * 6, offset);
+    VertexView<float> uvs = VAO::reserve<float>(uv, numGlyphs * 6, offset);
+
+    std::size_t vertex = 0;
+    for (const glyph_map_t::value_type& v : glyphs) {
         textures[idx] = v.first;
         offsets[idx++] = offset;
 
-        for (glyph_map_t::mapped_type::value_type rect : v.second) {
-            getVertexData(&rect, data, &(data[12]));
-
-            position->buffer->add(
-                static_cast<void*>(data),
-                sizeof(float) * 12,
-                position->attribute->size * position->valSize,
-                position->stride,
-                offset * position->stride + position->offset
-            );
-
-            uv->buffer->add(
-                static_cast<void*>(&(data[12])),
-                sizeof(float) * 12,
-                uv->attribute->size * uv->valSize,
-                uv->stride,
-                offset * uv->stride + uv->offset
-            );
+        for (const Glyph& glyph : v.second) {
+            getVertexData(&glyph.rect, &glyph.uv, positions.sub(vertex, 6), uvs.sub(vertex, 6));
 
+            vertex += 6;
             offset += 6;
         }
     }
 
-    return idx + 1;
+    return idx;
+}
+
+
+unsigned int TextRender::drawInstanced(
+    VertexBuffer* buffer, GLuint* textures, unsigned int* offsets, unsigned int first)
+{
+    std::size_t numGlyphs = 0;
+    for (const glyph_map_t::value_type& v : glyphs) {
+        numGlyphs += v.second.size();
+    }
+
+    constexpr std::size_t recordSize = sizeof(GlyphInstance);
+    unsigned int offset = first == APPEND ? buffer->size() / recordSize : first;
+
+    GlyphInstance* records = reinterpret_cast<GlyphInstance*>(
+        buffer->reserve(numGlyphs * recordSize, recordSize, recordSize, offset * recordSize));
+
+    std::size_t idx = 0;
+    for (const glyph_map_t::value_type& v : glyphs) {
+        textures[idx] = v.first;
+        offsets[idx++] = offset;
+
+        for (const Glyph& glyph : v.second) {
+            *records++ = {glyph.rect.x1, glyph.rect.y1, floatToHalf(glyph.rect.x2 - glyph.rect.x1),
+                floatToHalf(glyph.rect.y2 - glyph.rect.y1), glyph.index};
+        }
+        offset += v.second.size();
+    }
+
+    return idx;
 }
\ No newline at end of file
@@ -4,35 +4,159 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
-#include <utility>
+#include <tuple>
+#include <vector>
 
+#include "atlas.h"
+#include "glyph_rasterizer.h"
 #include "render_context.h"
 #include "polygons.h"
 
 
 struct Character {
-    GLuint texture;
+    /// Atlas page containing glyph bitmap.
+    unsigned int page;
+    /// Entry in UV table of atlas.
+    unsigned int index;
+    /// Texture coordinates of glyph bitmap, (u1, v1) is top left corner.
+    float u1, v1, u2, v2;
     unsigned int width, height;
     int bearingX, bearingY;
     long int advanceX;
 };
 
 
-GLuint generateTexture(char c, FT_Bitmap* bitmap);
+/// @brief Decodes UTF-8 text into code points.
+/// Invalid or truncated sequences decode to U+FFFD.
+/// @param codePoints Receives decoded code points, previous content is replaced.
+void decodeUtf8(const char* text, std::vector<char32_t>* codePoints);
+
+
+/// @brief Maps code points to glyphs in constant time.
+/// Latin-1 code points index a table directly, other code points are stored in an open addressing
+/// hash table with linear probing.
+class GlyphTable {
+  public:
+    GlyphTable();
+
+    /// @brief Returns glyph of code point or nullptr if not stored.
+    /// Returned pointer is invalidated by `insert`.
+    const Character* find(char32_t c) const;
+
+    /// @brief Stores glyph of code point, overwriting previous glyph.
+    void insert(char32_t c, const Character& character);
+
+    std::size_t size() const { return numDirect + numHashed; }
+
+  private:
+    static constexpr char32_t DIRECT_SIZE = 256;
+    static constexpr char32_t EMPTY = 0xFFFFFFFF;
+
+    struct Slot {
+        char32_t key;
+        Character value;
+    };
+
+    std::size_t slotIndex(char32_t c) const;
+    void grow();
+
+    Character direct[DIRECT_SIZE];
+    bool present[DIRECT_SIZE] = {};
+    std::size_t numDirect = 0;
+    std::vector<Slot> slots;    // Size is power of two
+    std::size_t numHashed = 0;
+};
+
+
+/// @brief Behaviour of `TextRender::layout` if glyphs are still rasterised in background.
+enum class MissPolicy {
+    /// Waits up to the configured time, glyphs not finished by then use placeholder.
+    Wait,
+    /// Uses placeholder without waiting.
+    Placeholder
+};
 
 
 class TextRender {
   public:
-    TextRender(const char* fpath, signed long idx);
+    /// Quad of a single glyph and its region in atlas texture.
+    struct Glyph {
+        Rectangle<float> rect;
+        Rectangle<float> uv;
+        /// Entry in UV table of atlas.
+        unsigned int index;
+    };
+
+    /// @brief Per instance record of a glyph drawn by `drawInstanced`.
+    /// Quad corners are expanded in the vertex shader, UVs are read from `uvTexture`.
+    struct GlyphInstance {
+        /// Lower left corner.
+        float x, y;
+        /// Width and height as half floats.
+        std::uint16_t width, height;
+        /// Entry in UV table of atlas, read as float attribute.
+        std::uint32_t glyph;
+    };
+    static_assert(sizeof(GlyphInstance) == 16, "Instance records have to be tightly packed");
+
+    /// Passed as `first` to append data after current end of buffer.
+    static constexpr unsigned int APPEND = UINT_MAX;
+
+    using glyph_map_t = std::map<GLuint, std::vector<Glyph>>;
+
+    /// Raster size of glyphs in `GlyphMode::Bitmap`.
+    static constexpr unsigned int BITMAP_PIXEL_SIZE = 48;
+    /// Raster size of glyphs in `GlyphMode::SDF`, distance fields scale well so a smaller size
+    /// serves all text sizes.
+    static constexpr unsigned int SDF_PIXEL_SIZE = 32;
+
+    /// @brief Uses face `idx` of font file `fpath`, shared with other instances through
+    /// `FaceRegistry`.
+    TextRender(const char* fpath, signed long idx, GlyphMode mode = GlyphMode::Bitmap);
+    ~TextRender();
+
+    TextRender(const TextRender&) = delete;
+    TextRender& operator=(const TextRender&) = delete;
 
     /// @brief Stores text to be rendered.
-    /// @param text Text to render.
+    /// @param text UTF-8 encoded text to render.
     /// @param x1, y1, x2, y2 Text will be placed in bounds (x1, y1) <->
     /// (x2, y2).
     void add(const char* text, float x1, float y1, float x2, float y2);
 
+    /// @brief Computes glyph quads of text without storing them.
+    /// @param x1, y1, x2, y2 Text will be placed in bounds (x1, y1) <-> (x2, y2).
+    /// @param glyphs Quads are appended to the list of their texture.
+    /// @param wait false uses placeholders for glyphs still being rasterised instead of waiting,
+    /// regardless of miss policy.
+    /// @return false if placeholders were used for glyphs still being rasterised.
+    bool layout(const char* text, float x1, float y1, float x2, float y2, glyph_map_t* glyphs,
+        bool wait = true);
+
+    /// @brief Rasterises missing glyphs on worker threads instead of the calling thread.
+    /// @param numThreads Number of workers, each opens its own face.
+    /// @param policy Handling of glyphs not finished when text is laid out.
+    /// @param maxWait Longest time a single layout waits with `MissPolicy::Wait`.
+    void rasterizeInBackground(unsigned int numThreads, MissPolicy policy,
+        std::chrono::microseconds maxWait = std::chrono::microseconds(2000));
+
+    /// @brief Rasterises and uploads all glyphs of UTF-8 encoded `charset`, blocks until done.
+    void prewarm(const char* charset);
+
+    /// @brief Copies glyphs finished by worker threads into atlas, called by `layout`.
+    /// @return Number of glyphs copied.
+    std::size_t uploadGlyphs();
+
+    /// @brief Returns counter incremented whenever any instance adds a glyph to the shared cache.
+    /// Text laid out with placeholders only has to be laid out again after it changed.
+    static std::size_t generation() { return _generation; }
+
     /// @brief Clears all collected text.
     void clear();
 
@@ -41,25 +165,66 @@ class TextRender {
     /// inserted.
     /// @param textures, offsets Returns id and vertex offset (from buffer
     /// beginning) for each used texture.
-    /// @return Number of vertices written to `textures` and `offsets`.
+    /// @param first Index of first vertex to write.
+    /// @return Number of entries written to `textures` and `offsets`.
     unsigned int draw(const AttributeBinding* position,
         const AttributeBinding* uv,
         GLuint* textures,
-        unsigned int* offsets);
-
-    /// @brief Returns number of different textures currently used.
+        unsigned int* offsets,
+        unsigned int first = APPEND);
+
+    /// @brief Inserts one `GlyphInstance` per stored glyph into buffer.
+    /// Each texture is drawn with `VAO::renderInstanced(0, 6, count, offset)`, which moves the
+    /// instance attribute pointers to `offset` on contexts without base instance draws. Shaders are
+    /// text_instanced.vertexshader and text.fragmentshader, the latter includes
+    /// glyph_coverage.glsl and has to be loaded through `ShaderVariants` (option `SDF`).
+    /// @param buffer Receives tightly packed records.
+    /// @param textures, offsets Returns id and instance offset (from buffer beginning) for each
+    /// used texture.
+    /// @param first Index of first instance to write.
+    /// @return Number of entries written to `textures` and `offsets`.
+    unsigned int drawInstanced(
+        VertexBuffer* buffer, GLuint* textures, unsigned int* offsets, unsigned int first = APPEND);
+
+    /// @brief Returns buffer texture with UV rectangles of all glyphs, to bind as
+    /// `samplerBuffer` for instanced drawing.
+    GLuint uvTexture() const { return _atlas->uvTexture(); }
+
+    /// @brief Returns number of different textures currently used. All glyphs share atlas
+    /// textures, this is the number of atlas pages touched by stored text.
     std::size_t getNumTextures() const { return glyphs.size(); }
 
   private:
-    using FaceID = std::pair<std::string, FT_Long>;
-    using CharCache = std::map<char, Character>;
+    using FaceID = std::tuple<std::string, FT_Long, GlyphMode>;
+    using CharCache = GlyphTable;
     using FaceCache = std::map<FaceID, CharCache>;
 
     static FaceCache _cache;
-
-    FT_Library library;
+    /// Shared by all faces, lives as long as the glyph cache.
+    static GlyphAtlas* _atlas;
+    /// Number of existing instances, atlas and glyph cache are freed with the last one.
+    static unsigned int numInstances;
+    static std::size_t _generation;
+
+    /// Rasterises `c` and copies its bitmap into atlas.
+    Character loadChar(char32_t c);
+    /// Copies bitmap into atlas.
+    Character storeGlyph(const unsigned char* pixels, unsigned int width, unsigned int height,
+        unsigned int pitch, int bearingX, int bearingY, long int advanceX);
+    /// Requests missing glyphs from workers and waits for them according to policy, unless
+    /// `wait` is false.
+    void awaitGlyphs(bool wait);
+
+    GlyphMode mode;
+    std::string path;
+    FT_Long faceIndex;
     FT_Face face;
+    GlyphRasterizer* rasterizer = nullptr;
+    MissPolicy policy = MissPolicy::Wait;
+    std::chrono::microseconds maxWait;
+    Character placeholder = {};
+    std::vector<GlyphBitmap> finished;    // Reused by `uploadGlyphs`
     CharCache* cache;
-    using glyph_map_t = std::map<GLuint, std::vector<Rectangle<float>>>;
     glyph_map_t glyphs;
+    std::vector<char32_t> codePoints;    // Reused by `layout`
 };
\ No newline at end of file
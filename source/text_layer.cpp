@@ -0,0 +1,185 @@
+#include "text_layer.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "buffer.h"
+#include "polygons.h"
+
+
+TextObject::TextObject(
+    TextLayer* layer, const char* text, float x1, float y1, float x2, float y2)
+    : layer(layer), _text(text), x1(x1), y1(y1), x2(x2), y2(y2)
+{
+}
+
+
+void TextObject::setText(const char* text)
+{
+    _text = text;
+    layer->update(this);
+}
+
+
+void TextObject::setBounds(float x1, float y1, float x2, float y2)
+{
+    this->x1 = x1;
+    this->y1 = y1;
+    this->x2 = x2;
+    this->y2 = y2;
+    layer->update(this);
+}
+
+
+TextLayer::TextLayer(TextRender* render, const AttributeBinding* position,
+    const AttributeBinding* uv, unsigned int maxVertex)
+    : render(render), position(position), uv(uv), allocator(maxVertex)
+{
+}
+
+
+TextLayer::~TextLayer()
+{
+    for (const std::map<std::size_t, TextObject*>::value_type& v : objects) {
+        delete v.second;
+    }
+}
+
+
+TextObject* TextLayer::create(const char* text, float x1, float y1, float x2, float y2)
+{
+    TextObject* object = new TextObject(this, text, x1, y1, x2, y2);
+    try {
+        update(object);
+    }
+    catch (...) {
+        delete object;
+        throw;
+    }
+
+    return object;
+}
+
+
+void TextLayer::remove(TextObject* object)
+{
+    if (object->first != OffsetAllocator::INVALID) {
+        objects.erase(object->first);
+        allocator.free(object->first);
+    }
+    incomplete.erase(object);
+    delete object;
+
+    batchesDirty = true;
+}
+
+
+std::map<GLuint, DrawBatch>& TextLayer::batches()
+{
+    // Only worth a new layout if glyphs arrived, possibly collected by another caller
+    if (!incomplete.empty()) {
+        render->uploadGlyphs();
+    }
+    if (!incomplete.empty() && TextRender::generation() != retryGeneration) {
+        retryGeneration = TextRender::generation();
+
+        // Glyphs still missing are drawn as placeholders rather than blocking the frame
+        std::set<TextObject*> retry;
+        retry.swap(incomplete);
+        for (TextObject* object : retry) {
+            update(object, false);
+        }
+    }
+
+    if (!batchesDirty) {
+        return _batches;
+    }
+
+    for (std::map<GLuint, DrawBatch>::value_type& v : _batches) {
+        v.second.clear();
+    }
+
+    // Objects are visited by position, ranges of neighbouring objects are merged
+    for (const std::map<std::size_t, TextObject*>::value_type& v : objects) {
+        unsigned int first = v.first;
+        for (const TextObject::Run& run : v.second->runs) {
+            _batches[run.texture].add(first, run.count);
+            first += run.count;
+        }
+    }
+
+    batchesDirty = false;
+    return _batches;
+}
+
+
+void TextLayer::update(TextObject* object, bool wait)
+{
+    for (TextRender::glyph_map_t::value_type& v : scratch) {
+        v.second.clear();
+    }
+    bool complete = render->layout(
+        object->_text.c_str(), object->x1, object->y1, object->x2, object->y2, &scratch, wait);
+    if (complete) {
+        incomplete.erase(object);
+    }
+    else {
+        incomplete.insert(object);
+    }
+
+    unsigned int numVertex = 0;
+    std::vector<TextObject::Run> runs;
+    for (const TextRender::glyph_map_t::value_type& v : scratch) {
+        if (!v.second.empty()) {
+            runs.push_back({v.first, (unsigned int)v.second.size() * 6});
+            numVertex += v.second.size() * 6;
+        }
+    }
+
+    // Empty text keeps a minimal range, so every object has a valid first vertex
+    unsigned int required = std::max(6u, numVertex);
+    if (required > object->capacity) {
+        if (object->first != OffsetAllocator::INVALID) {
+            objects.erase(object->first);
+            allocator.free(object->first);
+        }
+
+        // Spare room, so slightly longer text does not move object
+        unsigned int capacity = required + (required / 12) * 6;
+        object->first = allocator.allocate(capacity);
+        object->capacity = capacity;
+        if (object->first == OffsetAllocator::INVALID) {
+            object->capacity = 0;
+            object->runs.clear();
+            batchesDirty = true;
+            throw std::length_error("Text layer has no space left for text object");
+        }
+
+        objects[object->first] = object;
+        batchesDirty = true;
+    }
+
+    if (runs != object->runs) {
+        object->runs = runs;
+        batchesDirty = true;
+    }
+
+    if (numVertex == 0) {
+        return;
+    }
+
+    VertexView<float> positions = VAO::reserve<float>(position, numVertex, object->first);
+    VertexView<float> uvs = VAO::reserve<float>(uv, numVertex, object->first);
+
+    std::size_t vertex = 0;
+    for (const TextRender::glyph_map_t::value_type& v : scratch) {
+        for (const TextRender::Glyph& glyph : v.second) {
+            getVertexData(&glyph.rect, &glyph.uv, positions.sub(vertex, 6), uvs.sub(vertex, 6));
+            vertex += 6;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "render_context.h"
+#include "text.h"
+
+
+class TextLayer;
+
+
+/// @brief Handle to retained text, created by `TextLayer::create`.
+/// Owns a range of vertices inside the layer buffer. Changing text or bounds only rewrites this
+/// range.
+class TextObject {
+  public:
+    /// @brief Replaces text and rewrites vertices of this object.
+    void setText(const char* text);
+
+    /// @brief Moves text into bounds (x1, y1) <-> (x2, y2) and rewrites vertices of this object.
+    void setBounds(float x1, float y1, float x2, float y2);
+
+    const std::string& text() const { return _text; }
+
+  private:
+    friend class TextLayer;
+
+    /// Vertices of object using a single texture.
+    struct Run {
+        GLuint texture;
+        unsigned int count;
+
+        bool operator==(const Run& other) const = default;
+    };
+
+    TextObject(TextLayer* layer, const char* text, float x1, float y1, float x2, float y2);
+
+    TextLayer* layer;
+    std::string _text;
+    float x1, y1, x2, y2;
+    std::size_t first = OffsetAllocator::INVALID;
+    unsigned int capacity = 0;    // In vertices
+    std::vector<Run> runs;
+};
+
+
+/// @brief Collection of retained text objects sharing one vertex buffer.
+/// Vertices of unchanged objects are neither recomputed nor uploaded again. Draw ranges are only
+/// rebuilt after an object changed its size or textures.
+class TextLayer {
+  public:
+    /// @param render Provides font and layout.
+    /// @param position, uv Bindings vertices are written to. Bound buffer must keep its content
+    /// between frames, i.e. must not be a `StreamingBuffer`.
+    /// @param maxVertex Number of vertices available to all objects.
+    TextLayer(TextRender* render, const AttributeBinding* position, const AttributeBinding* uv,
+        unsigned int maxVertex);
+    ~TextLayer();
+
+    /// @brief Creates text object and writes its vertices.
+    /// @param x1, y1, x2, y2 Text will be placed in bounds (x1, y1) <-> (x2, y2).
+    TextObject* create(const char* text, float x1, float y1, float x2, float y2);
+
+    /// @brief Deletes object and releases its vertices.
+    void remove(TextObject* object);
+
+    /// @brief Returns vertex ranges of all objects, grouped by texture.
+    /// Objects laid out with placeholder glyphs are laid out again first if glyphs were added
+    /// since, no matter which caller uploaded them. These layouts never wait for glyphs.
+    std::map<GLuint, DrawBatch>& batches();
+
+    std::size_t numObjects() const { return objects.size(); }
+
+  private:
+    friend class TextObject;
+
+    /// Re-layouts object and writes its vertices, `wait` as for `TextRender::layout`.
+    void update(TextObject* object, bool wait = true);
+
+    TextRender* render;
+    const AttributeBinding* position;
+    const AttributeBinding* uv;
+    OffsetAllocator allocator;
+    std::map<std::size_t, TextObject*> objects;    // Ordered by first vertex
+    std::set<TextObject*> incomplete;    // Laid out with placeholder glyphs
+    std::size_t retryGeneration = 0;    // `TextRender::generation` at last retry
+    std::map<GLuint, DrawBatch> _batches;
+    bool batchesDirty = false;
+    TextRender::glyph_map_t scratch;
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "uniform_buffer.h"
+
+#include <GL/Glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "gl_state.h"
+#include "utility.h"
+
+
+UniformBuffer::UniformBuffer(const UniformBlockLayout& layout, GLuint binding)
+    : _binding(binding), data(layout.size, 0), members(layout.members)
+{
+}
+
+
+UniformBuffer::UniformBuffer(std::size_t size, GLuint binding) : _binding(binding), data(size, 0)
+{
+}
+
+
+UniformBuffer::~UniformBuffer()
+{
+    if (_id != 0) {
+        GLState::deleteBuffers(1, &_id);
+    }
+}
+
+
+void UniformBuffer::set(std::size_t offset, const void* values, std::size_t size)
+{
+    if (offset + size > data.size()) {
+        throw std::length_error("Write exceeds uniform block");
+    }
+
+    if (std::memcmp(data.data() + offset, values, size) == 0) {
+        return;
+    }
+
+    std::memcpy(data.data() + offset, values, size);
+    markDirty(offset, offset + size);
+}
+
+
+void UniformBuffer::upload()
+{
+    if (_id == 0) {
+        glGenBuffers(1, &_id);
+    }
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, _id);
+    if (!allocated) {
+        glBufferData(GL_UNIFORM_BUFFER, data.size(), data.data(), GL_DYNAMIC_DRAW);
+        allocated = true;
+    }
+    else {
+        for (const range_t& range : dirty) {
+            glBufferSubData(GL_UNIFORM_BUFFER, range.first, range.second - range.first,
+                data.data() + range.first);
+        }
+    }
+
+    dirty.clear();
+
+    // Skipped unless another buffer was attached to binding point in between
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, _binding, _id);
+}
+
+
+const BlockMember& UniformBuffer::member(const std::string& name) const
+{
+    std::map<std::string, BlockMember>::const_iterator it = members.find(name);
+    if (it == members.end()) {
+        throw std::invalid_argument("Uniform block has no member " + name);
+    }
+
+    return it->second;
+}
+
+
+void UniformBuffer::markDirty(std::size_t begin, std::size_t end)
+{
+    mergeRange(dirty, begin, end);
+}
+
+
+void UniformBuffer::setColumns(std::size_t offset, const void* values, std::size_t columns,
+    std::size_t columnSize, std::size_t stride)
+{
+    const std::uint8_t* src = static_cast<const std::uint8_t*>(values);
+    for (std::size_t i = 0; i < columns; i++) {
+        set(offset + i * stride, src + i * columnSize, columnSize);
+    }
+}
\ No newline at end of file
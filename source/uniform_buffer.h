@@ -0,0 +1,141 @@
+#pragma once
+
+#include <GL/Glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/// Location of a uniform block member inside block storage, as reported by GL.
+struct BlockMember {
+    GLenum type;
+    GLint offset;
+    GLint arraySize;
+    /// Bytes between array elements, 0 for non-arrays.
+    GLint arrayStride;
+    /// Bytes between matrix columns, 0 for non-matrices.
+    GLint matrixStride;
+};
+
+
+/// Size and member layout of a uniform block, reflected from a linked program.
+struct UniformBlockLayout {
+    GLuint index;
+    std::size_t size;
+    std::map<std::string, BlockMember> members;
+};
+
+
+/// @brief CPU mirror of a uniform block stored in a uniform buffer.
+/// Values are written at their std140 (or reflected) offsets. Writes that do not change the
+/// mirrored bytes are ignored, changed bytes are tracked as dirty ranges and uploaded by `upload`.
+/// A buffer attached to a binding point is read by every program whose block is bound to the same
+/// point, so shared data like per frame camera matrices is uploaded once for all programs.
+class UniformBuffer {
+  public:
+    using range_t = std::pair<std::size_t, std::size_t>;
+
+    /// @param layout Layout of block, e.g. from `ShaderProgram::getBlockLayout`.
+    /// @param binding Uniform buffer binding point the buffer is attached to.
+    UniformBuffer(const UniformBlockLayout& layout, GLuint binding);
+    /// @brief Creates buffer without reflected members, values must be written by offset.
+    UniformBuffer(std::size_t size, GLuint binding);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    /// @brief Copies `size` bytes to `offset` if they differ from mirrored content.
+    void set(std::size_t offset, const void* values, std::size_t size);
+
+    /// @brief Writes member `name` of block.
+    /// Matrices are written column by column using the reflected matrix stride.
+    template<typename T> void set(const std::string& name, const T& value);
+
+    /// @brief Writes `count` elements of array member `name`, starting at element `first`.
+    template<typename T>
+    void set(const std::string& name, const T* values, std::size_t count, std::size_t first = 0);
+
+    /// @brief Uploads dirty ranges and attaches buffer to its binding point.
+    void upload();
+
+    GLuint id() const { return _id; }
+    GLuint binding() const { return _binding; }
+    std::size_t size() const { return data.size(); }
+    const std::vector<range_t>& dirtyRanges() const { return dirty; }
+
+  private:
+    const BlockMember& member(const std::string& name) const;
+    void markDirty(std::size_t begin, std::size_t end);
+
+    /// Writes `columns` columns of `columnSize` bytes each with `stride` bytes in between.
+    void setColumns(std::size_t offset, const void* values, std::size_t columns,
+        std::size_t columnSize, std::size_t stride);
+
+    GLuint _id = 0;
+    GLuint _binding;
+    bool allocated = false;
+    std::vector<std::uint8_t> data;
+    std::vector<range_t> dirty;
+    std::map<std::string, BlockMember> members;
+};
+
+
+namespace {
+
+/// Number and size of columns of matrix types, which are stored with a reflected column stride.
+template<typename T> struct MatrixShape {
+    static constexpr std::size_t columns = 0;
+    static constexpr std::size_t columnSize = 0;
+};
+
+template<> struct MatrixShape<glm::mat2> {
+    static constexpr std::size_t columns = 2;
+    static constexpr std::size_t columnSize = 2 * sizeof(float);
+};
+
+template<> struct MatrixShape<glm::mat3> {
+    static constexpr std::size_t columns = 3;
+    static constexpr std::size_t columnSize = 3 * sizeof(float);
+};
+
+template<> struct MatrixShape<glm::mat4> {
+    static constexpr std::size_t columns = 4;
+    static constexpr std::size_t columnSize = 4 * sizeof(float);
+};
+
+}    // namespace
+
+
+template<typename T>
+inline void UniformBuffer::set(const std::string& name, const T& value)
+{
+    set(name, &value, 1);
+}
+
+
+template<typename T>
+inline void UniformBuffer::set(
+    const std::string& name, const T* values, std::size_t count, std::size_t first)
+{
+    const BlockMember& location = member(name);
+    std::size_t stride = location.arrayStride > 0 ? location.arrayStride : sizeof(T);
+
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t offset = location.offset + (first + i) * stride;
+
+        if constexpr (MatrixShape<T>::columns > 0) {
+            setColumns(offset, &values[i], MatrixShape<T>::columns, MatrixShape<T>::columnSize,
+                location.matrixStride);
+        }
+        else {
+            set(offset, &values[i], sizeof(T));
+        }
+    }
+}
\ No newline at end of file
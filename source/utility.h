@@ -1,10 +1,36 @@
 #pragma once
 
 #include <algorithm>
+#include <cstddef>
+#include <utility>
 #include <vector>
 
 
 template<typename T, typename Pred>
 typename std::vector<T>::iterator sortedInsert(std::vector<T>& vec, const T item, Pred pred) {
     return vec.insert(std::upper_bound(vec.begin(), vec.end(), item, pred), item);
+}
+
+
+/// @brief Adds half open range [begin, end) to sorted, non overlapping `ranges`.
+/// Overlapping and adjacent ranges are merged into one.
+inline void mergeRange(std::vector<std::pair<std::size_t, std::size_t>>& ranges,
+    std::size_t begin, std::size_t end)
+{
+    using range_t = std::pair<std::size_t, std::size_t>;
+
+    // First range which could overlap or touch [begin, end)
+    std::vector<range_t>::iterator first = std::lower_bound(ranges.begin(), ranges.end(), begin,
+        [](const range_t& range, std::size_t value) { return range.second < value; }
+    );
+
+    std::vector<range_t>::iterator last = first;
+    while (last != ranges.end() && last->first <= end) {
+        begin = std::min(begin, last->first);
+        end = std::max(end, last->second);
+        last++;
+    }
+
+    first = ranges.erase(first, last);
+    ranges.insert(first, std::make_pair(begin, end));
 }
\ No newline at end of file
@@ -13,9 +13,12 @@
 
 #include "cmake_config.h"
 #include "source/buffer.h"
+#include "source/gl_state.h"
 #include "source/render_context.h"
 #include "source/shader.h"
+#include "source/shader_variants.h"
 #include "source/text.h"
+#include "source/uniform_buffer.h"
 
 
 int init_glfw()
@@ -138,7 +141,7 @@ GLuint loadBMP_custom(const char* imagepath)
     glGenTextures(1, &textureID);
 
     // "Bind" the newly created texture : all future texture functions will modify this texture
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    GLState::bindTexture(GL_TEXTURE_2D, textureID);
 
     // Give the image to OpenGL
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
@@ -158,7 +161,6 @@ GLuint loadBMP_custom(const char* imagepath)
     // ... which requires mipmaps. Generate them automatically.
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    glBindTexture(GL_TEXTURE_2D, 0);
 
     // Return the ID of the texture we just created
     return textureID;
@@ -182,16 +184,22 @@ int main()
     std::string fragmentSource = readFile("../shaders/fragment.fragmentshader");
 
     ShaderProgram shader(vertexSource.c_str(), fragmentSource.c_str());
-    shader.registerGLSetting([]() { glActiveTexture(GL_TEXTURE0); });
+    shader.registerGLSetting([]() {
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::disable(GL_BLEND);
+    });
 
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 100.0f);
     glm::mat4 view =
         glm::lookAt(glm::vec3(3.0, 3.0, -8.0), glm::vec3(0.0, 0.0, 0.0), glm::vec3(0.0, 1.0, 0.0));
     glm::mat4 VP = projection * view;
-    shader.bindUniform("VP", GL_FALSE, &VP[0][0]);
+
+    // Per frame camera data, shared by all programs reading block at binding point 0
+    shader.bindBlock("Camera", 0);
+    UniformBuffer camera(shader.getBlockLayout("Camera"), 0);
 
     const GLint textureIdx = 0;
-    shader.bindUniform("textureSampler", &textureIdx);
+    shader.uniform<GLint>("textureSampler").set(textureIdx);
 
     GLuint texture = loadBMP_custom("../resources/uvtemplate.bmp");
 
@@ -237,9 +245,9 @@ int main()
     vao.addData(bindings[shader.getAttribIndex("uv")], cubeUvs, 36);
     vao.end();
 
-    vertexSource = readFile("../shaders/text.vertexshader");
-    fragmentSource = readFile("../shaders/text.fragmentshader");
-    ShaderProgram textShader(vertexSource.c_str(), fragmentSource.c_str());
+    ShaderVariants textVariants(
+        "../shaders/text.vertexshader", "../shaders/text.fragmentshader", {"SDF"});
+    ShaderProgram& textShader = *textVariants.get(textVariants.bit("SDF"));
 
     VertexBuffer textBuf(1);
     VertexAttribute textPosFmt {2, GL_FLOAT, GL_FALSE};
@@ -251,15 +259,16 @@ int main()
 
     // glm::mat4 textProjection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f);
     glm::mat4 textProjection = glm::mat4(1.0f);  // Identity
-    textShader.bindUniform("P", GL_FALSE, &textProjection[0][0]);
-    textShader.bindUniform("textureSampler", &textureIdx);
+    UniformHandle<glm::mat4> textP = textShader.uniform<glm::mat4>("P");
+    textP.set(textProjection);
+    textShader.uniform<GLint>("textureSampler").set(textureIdx);
     textShader.registerGLSetting([]() {
-        glActiveTexture(GL_TEXTURE0);
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        GLState::activeTexture(GL_TEXTURE0);
+        GLState::enable(GL_BLEND);
+        GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     });
 
-    TextRender textContext("../resources/fonts/ARIALMT.ttf", 0);
+    TextRender textContext("../resources/fonts/ARIALMT.ttf", 0, GlyphMode::SDF);
     textContext.add("Hello World!", 0.7, 0.45, 0.9, 0.55);
 
     textVAO.begin();
@@ -274,24 +283,26 @@ int main()
     textVAO.end();
 
     glClearColor(0.0, 0.0, 0.0, 0.0f);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::depthFunc(GL_LESS);
 
     do {
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glDisable(GL_BLEND);
+        camera.set("VP", VP);
+        camera.upload();
+
         shader.use();
-        glBindTexture(GL_TEXTURE_2D, texture);        
+        GLState::bindTexture(GL_TEXTURE_2D, texture);
         vao.render(0, 180);
 
         textShader.use();
         for (int i = 0; i < numTextures - 1; i++) {
-            glBindTexture(GL_TEXTURE_2D, charTextures[i]);
+            GLState::bindTexture(GL_TEXTURE_2D, charTextures[i]);
             textVAO.render(offsets[i], offsets[i + 1] - offsets[i]);
         }
-        glBindTexture(GL_TEXTURE_2D, charTextures[numTextures - 1]);
-        textVAO.render(offsets[numTextures - 1], vao.getNumVertex() - offsets[numTextures - 1]);
+        GLState::bindTexture(GL_TEXTURE_2D, charTextures[numTextures - 1]);
+        textVAO.render(offsets[numTextures - 1], textVAO.getNumVertex() - offsets[numTextures - 1]);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
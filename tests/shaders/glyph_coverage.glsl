@@ -0,0 +1,11 @@
+// Coverage of glyph texel, SDF selects distance field glyphs over coverage bitmaps
+float glyphCoverage(sampler2D glyph, vec2 uv){
+#ifdef SDF
+    // Distance field stores 0.5 on glyph outline, smooth over one screen pixel
+    float dist = texture(glyph, uv).r;
+    float width = fwidth(dist);
+    return smoothstep(0.5 - width, 0.5 + width, dist);
+#else
+    return texture(glyph, uv).r;
+#endif
+}
\ No newline at end of file
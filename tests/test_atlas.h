@@ -0,0 +1,37 @@
+#include <testsuite.h>
+
+#include "source/atlas.h"
+
+
+TEST_CASE("SkylinePacker::pack - no overlap")
+{
+    SkylinePacker packer(64, 64);
+
+    unsigned int xs[6];
+    unsigned int ys[6];
+    const unsigned int widths[6] = {20, 30, 14, 40, 24, 10};
+    const unsigned int heights[6] = {10, 20, 30, 8, 16, 12};
+
+    bool passed = true;
+    for (int i = 0; i < 6; i++) {
+        passed = passed && packer.pack(widths[i], heights[i], &xs[i], &ys[i]);
+        passed = passed && xs[i] + widths[i] <= 64 && ys[i] + heights[i] <= 64;
+    }
+
+    for (int i = 0; i < 6; i++) {
+        for (int j = i + 1; j < 6; j++) {
+            bool separate = xs[i] + widths[i] <= xs[j] || xs[j] + widths[j] <= xs[i] ||
+                            ys[i] + heights[i] <= ys[j] || ys[j] + heights[j] <= ys[i];
+            passed = passed && separate;
+        }
+    }
+
+    // First row is filled left to right before stacking
+    passed = passed && xs[0] == 0 && ys[0] == 0 && xs[1] == 20 && ys[1] == 0;
+
+    unsigned int x;
+    unsigned int y;
+    passed = passed && !packer.pack(65, 1, &x, &y);
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
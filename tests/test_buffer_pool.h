@@ -0,0 +1,55 @@
+#include <testsuite.h>
+
+#include <cstddef>
+
+#include "source/buffer_pool.h"
+
+
+TEST_CASE("OffsetAllocator - best fit among free ranges")
+{
+    OffsetAllocator allocator(100);
+
+    std::size_t a = allocator.allocate(30);
+    allocator.allocate(10);
+    std::size_t c = allocator.allocate(10);
+    allocator.allocate(50);
+    allocator.free(a);
+    allocator.free(c);
+    bool passed = allocator.numFreeRanges() == 2 && allocator.largestFree() == 30;
+
+    // Range at 40 is smaller than range at 0 but still fits
+    passed = passed && allocator.allocate(8) == 40;
+    passed = passed && allocator.allocate(25) == 0;
+    passed = passed && allocator.allocate(8) == OffsetAllocator::INVALID;
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("OffsetAllocator - coalescing")
+{
+    OffsetAllocator allocator(100);
+
+    std::size_t a = allocator.allocate(10);
+    std::size_t b = allocator.allocate(20);
+    std::size_t c = allocator.allocate(30);
+    bool passed = a == 0 && b == 10 && c == 30 && allocator.used() == 60;
+    passed = passed && allocator.allocate(50) == OffsetAllocator::INVALID;
+
+    allocator.free(a);
+    allocator.free(c);    // Merges with trailing free range
+    passed = passed && allocator.numFreeRanges() == 2 && allocator.largestFree() == 70;
+
+    allocator.free(b);    // Merges with both neighbours
+    passed = passed && allocator.numFreeRanges() == 1 && allocator.largestFree() == 100;
+    passed = passed && allocator.used() == 0;
+
+    // Best fit prefers smallest sufficient range
+    a = allocator.allocate(10);
+    b = allocator.allocate(5);
+    c = allocator.allocate(85);
+    allocator.free(a);
+    passed = passed && allocator.allocate(4) == 0;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
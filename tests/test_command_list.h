@@ -0,0 +1,79 @@
+#include <testsuite.h>
+
+#include <glm/glm.hpp>
+#include <thread>
+
+#include "source/command_list.h"
+#include "source/gl_state.h"
+#include "source/render_context.h"
+#include "source/shader.h"
+
+
+static const char* commandTestVertex = R"(#version 330 core
+layout(location = 0) in vec2 position;
+void main(){
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+static const char* commandTestFragment = R"(#version 330 core
+out vec4 color;
+uniform vec4 tint;
+void main(){
+    color = tint;
+}
+)";
+
+
+TEST_CASE("CommandList - recorded on worker, replayed on context thread")
+{
+    VertexBuffer buf(1);
+    VertexAttribute posFmt = {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* pos = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    ShaderProgram program(commandTestVertex, commandTestFragment);
+    UniformHandle<glm::vec4> tint = program.uniform<glm::vec4>("tint");
+    GLuint texture;
+    glGenTextures(1, &texture);
+
+    CommandList list;
+    std::thread worker([&]() {
+        GLfloat vertices[6] = {-1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f};
+        list.addData(&vao, pos, vertices, 3);
+        list.end(&vao);
+        list.use(&program);
+        list.setUniform(tint, glm::vec4(0.25f, 0.5f, 0.75f, 1.0f));
+        list.bindTexture(GL_TEXTURE1, GL_TEXTURE_2D, texture);
+        list.render(&vao, 0, 3);
+    });
+    worker.join();
+
+    // Nothing reaches GL before execute
+    bool passed = list.size() == 6 && vao.getNumVertex() == 0;
+
+    list.execute();
+
+    GLint id;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &id);
+    GLfloat value[4];
+    glGetUniformfv(id, glGetUniformLocation(id, "tint"), value);
+    passed = passed && value[1] == 0.5f && value[3] == 1.0f;
+
+    GLint bound;
+    glActiveTexture(GL_TEXTURE1);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    GLState::invalidate();
+    passed = passed && (GLuint)bound == texture;
+
+    passed = passed && vao.getNumVertex() == 3 && glGetError() == GL_NO_ERROR;
+
+    list.clear();
+    passed = passed && list.size() == 0;
+
+    program.disable();
+    GLState::deleteTextures(1, &texture);
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
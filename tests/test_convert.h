@@ -0,0 +1,35 @@
+#include <testsuite.h>
+
+#include <cstdint>
+
+#include "source/convert.h"
+
+
+TEST_CASE("packFloats - normalized and packed types")
+{
+    // More than 16 values to cover vectorised and scalar tail
+    float values[18];
+    for (int i = 0; i < 18; i++) {
+        values[i] = -1.5f + i * 0.2f;
+    }
+
+    std::int8_t snorm8[18];
+    std::uint16_t unorm16[18];
+    packFloats(values, 18, 1, GL_BYTE, GL_TRUE, snorm8);
+    packFloats(values, 18, 1, GL_UNSIGNED_SHORT, GL_TRUE, unorm16);
+
+    bool passed = snorm8[0] == -127 && snorm8[17] == 127 && unorm16[0] == 0 && unorm16[17] == 65535;
+    passed = passed && snorm8[10] == 64 && unorm16[10] == 32768;    // 0.5
+
+    std::uint16_t half[2];
+    float halfValues[2] = {1.0f, -2.0f};
+    packFloats(halfValues, 2, 1, GL_HALF_FLOAT, GL_FALSE, half);
+    passed = passed && half[0] == 0x3C00 && half[1] == 0xC000;
+
+    std::uint32_t packed;
+    float packedValues[4] = {1.0f, -1.0f, 0.0f, 1.0f};
+    packFloats(packedValues, 1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, &packed);
+    passed = passed && packed == ((0x1FFu) | (0x201u << 10) | (1u << 30));
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
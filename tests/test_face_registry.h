@@ -0,0 +1,27 @@
+#include <testsuite.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include "source/face_registry.h"
+
+
+TEST_CASE("FaceRegistry - faces shared and released")
+{
+    const char* path = "../resources/fonts/ARIALMT.ttf";
+
+    FT_Face a = FaceRegistry::acquire(path, 0, 48);
+    FT_Face b = FaceRegistry::acquire(path, 0, 48);
+    FT_Face c = FaceRegistry::acquire(path, 0, 32);
+    bool passed = a == b && a != c;
+    passed = passed && FaceRegistry::numFaces() == 2 && FaceRegistry::numFiles() == 1;
+
+    FaceRegistry::release(a);
+    passed = passed && FaceRegistry::numFaces() == 2;
+    FaceRegistry::release(b);
+    passed = passed && FaceRegistry::numFaces() == 1 && FaceRegistry::numFiles() == 1;
+    FaceRegistry::release(c);
+    passed = passed && FaceRegistry::numFaces() == 0 && FaceRegistry::numFiles() == 0;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <testsuite.h>
+
+#include "source/gl_state.h"
+
+
+TEST_CASE("GLState - redundant calls skipped")
+{
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+
+    GLState::invalidate();
+    GLState::resetCounters();
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    GLStateCounters calls = GLState::counters();
+    bool passed = calls.issued == 3 && calls.skipped == 1;
+
+    GLint bound;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &bound);
+    passed = passed && (GLuint)bound == buffers[1];
+
+    // Deleting a bound buffer resets the cached binding to 0, so rebinding 0 is skipped
+    GLState::deleteBuffers(1, &buffers[1]);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    passed = passed && GLState::counters().skipped == 2;
+
+    // A regenerated buffer may reuse the deleted id, its first bind must be issued
+    glGenBuffers(1, &buffers[1]);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    calls = GLState::counters();
+    passed = passed && calls.issued == 4 && calls.skipped == 2;
+
+    GLState::enable(GL_BLEND);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::disable(GL_BLEND);
+    calls = GLState::counters();
+    passed = passed && calls.issued == 7 && calls.skipped == 4;
+    passed = passed && glIsEnabled(GL_BLEND) == GL_FALSE;
+
+    GLState::deleteBuffers(2, buffers);
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include <testsuite.h>
+
+#include <chrono>
+#include <vector>
+
+#include "source/glyph_rasterizer.h"
+
+
+TEST_CASE("GlyphRasterizer - glyphs rasterised on workers")
+{
+    GlyphRasterizer rasterizer("../resources/fonts/ARIALMT.ttf", 0, 48, GlyphMode::Bitmap, 2);
+
+    const char32_t codes[4] = {U'A', U'g', U' ', U'A'};
+    for (char32_t c : codes) {
+        rasterizer.request(c);
+    }
+    bool passed = rasterizer.numPending() == 3;    // Duplicate request ignored
+
+    std::vector<GlyphBitmap> glyphs;
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (glyphs.size() < 3 && rasterizer.waitUntil(deadline)) {
+        rasterizer.collect(&glyphs);
+    }
+    passed = passed && glyphs.size() == 3 && rasterizer.numPending() == 0;
+
+    for (const GlyphBitmap& glyph : glyphs) {
+        passed = passed && glyph.pixels.size() == glyph.width * glyph.height;
+        passed = passed && glyph.advanceX > 0;
+        passed = passed && (glyph.code == U' ') == (glyph.width == 0);
+    }
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include <testsuite.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "source/interleave.h"
+
+
+TEST_CASE("interleave - all kernel sizes")
+{
+    const std::size_t numVertex = 1001;
+    const std::size_t sizes[5] = {4, 8, 12, 16, 6};
+    const std::size_t stride = 4 + 8 + 12 + 16 + 6;
+
+    std::vector<std::uint8_t> src[5];
+    InterleaveStream streams[5];
+    std::size_t offset = 0;
+    for (int s = 0; s < 5; s++) {
+        src[s].resize(numVertex * sizes[s]);
+        for (std::size_t i = 0; i < src[s].size(); i++) {
+            src[s][i] = static_cast<std::uint8_t>(i * 7 + s);
+        }
+
+        streams[s] = {src[s].data(), sizes[s], offset};
+        offset += sizes[s];
+    }
+
+    std::vector<std::uint8_t> dest(numVertex * stride);
+    interleave(dest.data(), stride, streams, 5, numVertex);
+
+    bool passed = true;
+    for (std::size_t i = 0; i < numVertex && passed; i++) {
+        for (int s = 0; s < 5; s++) {
+            const std::uint8_t* vertex = dest.data() + i * stride + streams[s].offset;
+            if (std::memcmp(vertex, src[s].data() + i * sizes[s], sizes[s]) != 0) {
+                passed = false;
+            }
+        }
+    }
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include <testsuite.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "source/mesh.h"
+
+
+TEST_CASE("weldVertices - in place")
+{
+    float vertices[12] = {1, 2, 3, 4, 1, 2, 5, 6, 3, 4, 1, 2};
+    std::uint32_t indices[6];
+
+    std::size_t numUnique = weldVertices(vertices, 6, 2 * sizeof(float), vertices, indices);
+
+    const std::uint32_t expectedIndices[6] = {0, 1, 0, 2, 1, 0};
+    const float expectedVertices[6] = {1, 2, 3, 4, 5, 6};
+    bool passed = numUnique == 3;
+    for (int i = 0; i < 6 && passed; i++) {
+        passed = indices[i] == expectedIndices[i] && vertices[i] == expectedVertices[i];
+    }
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("optimizeVertexCache - grid")
+{
+    const std::uint32_t n = 16;
+    std::uint32_t indices[n * n * 6];
+    std::size_t numIndex = 0;
+
+    // Column major triangle order, poor locality
+    for (std::uint32_t x = 0; x < n; x++) {
+        for (std::uint32_t y = 0; y < n; y++) {
+            std::uint32_t a = y * (n + 1) + x;
+            std::uint32_t quad[6] = {a, a + 1, a + n + 1, a + 1, a + n + 2, a + n + 1};
+            for (int i = 0; i < 6; i++) {
+                indices[numIndex++] = quad[i];
+            }
+        }
+    }
+
+    std::size_t numVertex = (n + 1) * (n + 1);
+    OptimizationReport report = optimizeVertexCache(indices, numIndex, numVertex);
+
+    std::uint32_t used[(n + 1) * (n + 1)] = {};
+    for (std::size_t i = 0; i < numIndex; i++) {
+        used[indices[i]]++;
+    }
+    bool passed = report.after.acmr < report.before.acmr && report.after.atvr >= 1.0f;
+    for (std::size_t v = 0; v < numVertex && passed; v++) {
+        passed = used[v] > 0;
+    }
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include <testsuite.h>
+
+#include "source/gl_state.h"
+#include "source/render_context.h"
+#include "source/render_queue.h"
+#include "source/shader.h"
+
+
+static const char* queueTestVertex = R"(#version 330 core
+layout(location = 0) in vec2 position;
+void main(){
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+)";
+
+static const char* queueTestFragment = R"(#version 330 core
+out vec4 color;
+uniform sampler2D textureSampler;
+void main(){
+    color = texture(textureSampler, vec2(0.5));
+}
+)";
+
+
+TEST_CASE("RenderQueue - sorted by key and adjacent ranges merged")
+{
+    VertexBuffer buf(1);
+    VertexAttribute posFmt = {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* pos = vao.bindBuffer(&posFmt, 0, &buf, sizeof(GLfloat));
+    vao.initialize();
+
+    GLfloat vertices[18] = {};
+    vao.begin();
+    vao.addData(pos, vertices, 9);
+    vao.end();
+
+    ShaderProgram programA(queueTestVertex, queueTestFragment);
+    ShaderProgram programB(queueTestVertex, queueTestFragment);
+    GLuint textures[2];
+    glGenTextures(2, textures);
+
+    RenderState state = {true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, false, GL_LESS};
+    DrawItem a0 = {RenderQueue::makeKey(0, 1, 0, 1, 0), &programA, &vao, {textures[0]}, state,
+        0, 3, false, 0};
+    DrawItem a3 = a0;
+    a3.first = 3;
+    DrawItem b0 = {RenderQueue::makeKey(0, 2, 0, 2, 0), &programB, &vao, {textures[1]}, state,
+        0, 3, false, 0};
+    DrawItem b3 = b0;
+    b3.first = 3;
+    // Later layer, drawn last although submitted first
+    DrawItem a6 = a0;
+    a6.key = RenderQueue::makeKey(1, 1, 0, 1, 0);
+    a6.first = 6;
+
+    RenderQueue queue;
+    for (const DrawItem& item : {a6, a0, b0, a3, b3}) {
+        queue.submit(item);
+    }
+    queue.flush();
+
+    const RenderQueueStats& unsorted = queue.unsortedStats();
+    bool passed = unsorted.drawCalls == 5 && unsorted.programChanges == 4 &&
+                  unsorted.textureChanges == 4 && unsorted.vaoChanges == 1 &&
+                  unsorted.stateChanges == 1;
+
+    // a0 and a3 merge, a6 follows b0 and b3
+    const RenderQueueStats& sorted = queue.sortedStats();
+    passed = passed && sorted.drawCalls == 3 && sorted.programChanges == 3 &&
+             sorted.textureChanges == 3 && sorted.vaoChanges == 1 && sorted.stateChanges == 1;
+
+    passed = passed && queue.size() == 0 && glGetError() == GL_NO_ERROR;
+
+    GLState::deleteTextures(2, textures);
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include <testsuite.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <stdexcept>
+
+#include "source/shader.h"
+
+
+static const char* uniformTestVertex = R"(#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 P;
+uniform float scale[2];
+void main(){
+    gl_Position = P * vec4(position * scale[0] * scale[1], 1.0);
+}
+)";
+
+static const char* uniformTestFragment = R"(#version 330 core
+out vec4 color;
+uniform vec4 tint;
+void main(){
+    color = tint;
+}
+)";
+
+
+TEST_CASE("ShaderProgram::uniform - resolved and type checked")
+{
+    ShaderProgram program(uniformTestVertex, uniformTestFragment);
+
+    UniformHandle<glm::vec4> tint = program.uniform<glm::vec4>("tint");
+    UniformHandle<GLfloat> scale = program.uniform<GLfloat>("scale");
+    bool passed = tint.valid() && scale.valid();
+
+    bool threw = false;
+    try {
+        program.uniform<glm::mat4>("tint");
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    passed = passed && threw;
+
+    threw = false;
+    try {
+        program.uniform<GLfloat>("missing");
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    passed = passed && threw;
+
+    // Values set before use are uploaded by use, later ones immediately
+    tint.set(glm::vec4(0.25f, 0.5f, 0.75f, 1.0f));
+    program.use();
+    const GLfloat scales[2] = {2.0f, 3.0f};
+    scale.set(scales, 2);
+
+    GLint id;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &id);
+    GLfloat value[4];
+    glGetUniformfv(id, glGetUniformLocation(id, "tint"), value);
+    passed = passed && value[1] == 0.5f && value[3] == 1.0f;
+    glGetUniformfv(id, glGetUniformLocation(id, "scale[1]"), value);
+    passed = passed && value[0] == 3.0f;
+
+    program.disable();
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("ShaderProgram::uniform - initialised uniform set to zero")
+{
+    const char* fragment = R"(#version 330 core
+out vec4 color;
+uniform float gain = 2.0;
+void main(){
+    color = vec4(gain);
+}
+)";
+    ShaderProgram program(uniformTestVertex, fragment);
+    program.use();
+
+    // Cached value starts at initialiser, so writing zero is not dropped as redundant
+    program.uniform<GLfloat>("gain").set(0.0f);
+
+    GLint id;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &id);
+    GLfloat value = -1.0f;
+    glGetUniformfv(id, glGetUniformLocation(id, "gain"), &value);
+    bool passed = value == 0.0f;
+
+    program.disable();
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("ShaderProgram - reflection restored from program cache")
+{
+    std::filesystem::remove_all("test_program_cache");
+    ShaderProgram::setCacheDirectory("test_program_cache");
+
+    bool passed = true;
+    bool fromCache[2];
+    for (int i = 0; i < 2; i++) {
+        ShaderProgram program(uniformTestVertex, uniformTestFragment);
+        passed = passed && program.getNumAttribs() == 1 && program.getAttribIndex("position") == 0;
+        passed = passed && program.uniform<glm::mat4>("P").valid();
+        fromCache[i] = program.fromCache();
+    }
+
+    GLint numFormats = 0;
+    if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    }
+    bool stored = std::filesystem::exists("test_program_cache") &&
+                  !std::filesystem::is_empty("test_program_cache");
+    passed = passed && (stored || numFormats == 0);
+    // Second program is loaded from file stored by first one
+    passed = passed && !fromCache[0] && fromCache[1] == stored;
+
+    // Entry claiming a larger binary than the file holds is compiled again
+    if (stored) {
+        std::filesystem::path entry =
+            std::filesystem::directory_iterator("test_program_cache")->path();
+        std::fstream file(entry, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint32_t size = 0xFFFFFFF0;
+        file.seekp(3 * sizeof(std::uint32_t));    // Magic, version and format precede size
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.close();
+
+        ShaderProgram program(uniformTestVertex, uniformTestFragment);
+        passed = passed && !program.fromCache() && program.uniform<glm::mat4>("P").valid();
+    }
+
+    ShaderProgram::setCacheDirectory("");
+    std::filesystem::remove_all("test_program_cache");
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("ShaderProgram::createAsync - reflected once ready")
+{
+    PendingProgram pending = ShaderProgram::createAsync(uniformTestVertex, uniformTestFragment);
+    while (!pending.ready()) {
+    }
+
+    ShaderProgram* program = pending.get();
+    bool passed = program != nullptr && pending.get() == nullptr;
+    passed = passed && program->getNumAttribs() == 1 && program->uniform<glm::vec4>("tint").valid();
+
+    delete program;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
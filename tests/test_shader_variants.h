@@ -0,0 +1,105 @@
+#include <testsuite.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "source/shader_variants.h"
+
+
+static void writeTestFile(const std::string& path, const std::string& content)
+{
+    std::ofstream file(path);
+    file << content;
+}
+
+
+TEST_CASE("resolveIncludes - includes once with line directives")
+{
+    std::filesystem::create_directories("test_includes/lib");
+    writeTestFile("test_includes/main.glsl",
+        "#version 330 core\n#include \"lib/a.glsl\"\n#include \"lib/a.glsl\"\nvoid main(){}\n");
+    // Relative to including file, includes back into a.glsl end the cycle
+    writeTestFile("test_includes/lib/a.glsl", "float a;\n#include \"b.glsl\"\n");
+    writeTestFile("test_includes/lib/b.glsl", "#include \"a.glsl\"\nfloat b;\n");
+
+    std::string source = resolveIncludes("test_includes/main.glsl");
+    bool passed = source == "#version 330 core\n"
+                            "#line 1 1\n"
+                            "float a;\n"
+                            "#line 1 2\n"
+                            "\n"
+                            "float b;\n"
+                            "#line 3 1\n"
+                            "#line 3 0\n"
+                            "\n"
+                            "void main(){}\n";
+
+    bool threw = false;
+    try {
+        resolveIncludes("test_includes/missing.glsl");
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    passed = passed && threw;
+
+    std::filesystem::remove_all("test_includes");
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("injectDefines - defines follow version line")
+{
+    std::string source = injectDefines("#version 330 core\nvoid main(){}\n",
+        {{"SDF", ""}, {"SCALE", "2.0"}});
+    bool passed = source == "#version 330 core\n"
+                            "#define SCALE 2.0\n"
+                            "#define SDF\n"
+                            "#line 2 0\n"
+                            "void main(){}\n";
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("ShaderVariants - compiled once per mask")
+{
+    std::filesystem::create_directories("test_variants");
+    writeTestFile("test_variants/variant.vertexshader",
+        "#version 330 core\nlayout(location = 0) in vec3 position;\n"
+        "void main(){\n    gl_Position = vec4(position, 1.0);\n}\n");
+    writeTestFile("test_variants/variant.fragmentshader",
+        "#version 330 core\nout vec4 color;\nvoid main(){\n"
+        "#ifdef RED\n    color = vec4(1.0, 0.0, 0.0, 1.0);\n"
+        "#else\n    color = vec4(BRIGHTNESS);\n#endif\n}\n");
+
+    ShaderVariants variants("test_variants/variant.vertexshader",
+        "test_variants/variant.fragmentshader", {"RED", "UNUSED"}, {{"BRIGHTNESS", "0.5"}});
+    std::filesystem::remove_all("test_variants");
+
+    ShaderProgram* plain = variants.get(0);
+    ShaderProgram* red = variants.get(variants.bit("RED"));
+    bool passed = plain != red && variants.get(0) == plain && variants.numCompiled() == 2;
+
+    bool threw = false;
+    try {
+        variants.get(1 << 2);
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    passed = passed && threw;
+
+    threw = false;
+    try {
+        variants.bit("GREEN");
+    }
+    catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    passed = passed && threw;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
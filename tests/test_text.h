@@ -0,0 +1,153 @@
+#include <testsuite.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "source/convert.h"
+#include "source/gl_state.h"
+#include "source/shader_variants.h"
+#include "source/text.h"
+
+
+/// Exposes CPU copy of buffer content.
+class InspectedBuffer : public VertexBuffer {
+  public:
+    using VertexBuffer::VertexBuffer;
+
+    const std::uint8_t* bytes() const { return data; }
+};
+
+
+/// Returns whether UV table entry of @p glyph matches its atlas rectangle.
+static bool uvEntryMatches(GLuint uvTexture, const TextRender::Glyph& glyph)
+{
+    GLint buffer;
+    glBindTexture(GL_TEXTURE_BUFFER, uvTexture);
+    glGetIntegerv(GL_TEXTURE_BUFFER_DATA_STORE_BINDING, &buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+    float uv[4];
+    glGetBufferSubData(GL_COPY_READ_BUFFER, glyph.index * sizeof(uv), sizeof(uv), uv);
+    GLState::invalidate();
+
+    return uv[0] == glyph.uv.x1 && uv[1] == glyph.uv.y1 && uv[2] == glyph.uv.x2 &&
+           uv[3] == glyph.uv.y2;
+}
+
+
+TEST_CASE("decodeUtf8 - multi byte and invalid sequences")
+{
+    std::vector<char32_t> codePoints;
+
+    // "aé€😀"
+    decodeUtf8("a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80", &codePoints);
+    bool passed = codePoints == std::vector<char32_t> {U'a', 0xE9, 0x20AC, 0x1F600};
+
+    // Stray continuation, overlong encoding, truncated sequence
+    decodeUtf8("\x80" "b" "\xC0\xAF" "\xE2\x82", &codePoints);
+    passed = passed && codePoints == std::vector<char32_t> {0xFFFD, U'b', 0xFFFD, 0xFFFD};
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("GlyphTable - direct and hashed code points")
+{
+    GlyphTable table;
+    Character character = {};
+
+    bool passed = table.find(U'a') == nullptr && table.find(0x4E00) == nullptr;
+
+    for (char32_t c = 0; c < 1000; c++) {
+        character.advanceX = c;
+        table.insert(c * 7, character);
+    }
+    passed = passed && table.size() == 1000;
+
+    for (char32_t c = 0; c < 1000; c++) {
+        const Character* found = table.find(c * 7);
+        passed = passed && found != nullptr && found->advanceX == (long int)c;
+    }
+    passed = passed && table.find(8) == nullptr && table.find(7001) == nullptr;
+
+    // Overwriting does not add entries
+    character.advanceX = -1;
+    table.insert(7 * 500, character);
+    passed = passed && table.size() == 1000 && table.find(7 * 500)->advanceX == -1;
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("TextRender::drawInstanced - records match glyph layout")
+{
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0);
+    TextRender::glyph_map_t expected;
+    font.layout("Tx", -1.0f, -1.0f, 0.0f, 0.0f, &expected);
+    font.add("Tx", -1.0f, -1.0f, 0.0f, 0.0f);
+
+    InspectedBuffer buf(1);
+    GLuint textures[4];
+    unsigned int offsets[4];
+    unsigned int numTextures = font.drawInstanced(&buf, textures, offsets);
+
+    const std::vector<TextRender::Glyph>& glyphs = expected.begin()->second;
+    bool passed = numTextures == 1 && textures[0] == expected.begin()->first && offsets[0] == 0;
+    passed = passed && glyphs.size() == 2 && buf.size() == 2 * sizeof(TextRender::GlyphInstance);
+
+    const TextRender::GlyphInstance* records =
+        reinterpret_cast<const TextRender::GlyphInstance*>(buf.bytes());
+    GLuint uvTexture = font.uvTexture();
+    for (std::size_t i = 0; passed && i < glyphs.size(); i++) {
+        const TextRender::Glyph& glyph = glyphs[i];
+        passed = records[i].x == glyph.rect.x1 && records[i].y == glyph.rect.y1;
+        passed = passed && records[i].width == floatToHalf(glyph.rect.x2 - glyph.rect.x1);
+        passed = passed && records[i].height == floatToHalf(glyph.rect.y2 - glyph.rect.y1);
+        passed = passed && records[i].glyph == glyph.index && glyph.index != 0;
+        passed = passed && uvEntryMatches(uvTexture, glyph);
+    }
+
+    // Explicit offset overwrites, APPEND continues after buffer end
+    numTextures = font.drawInstanced(&buf, textures, offsets, 0);
+    passed = passed && offsets[0] == 0 && buf.size() == 2 * sizeof(TextRender::GlyphInstance);
+    numTextures = font.drawInstanced(&buf, textures, offsets);
+    passed = passed && offsets[0] == 2 && buf.size() == 4 * sizeof(TextRender::GlyphInstance);
+    passed = passed && std::memcmp(buf.bytes() + 2 * sizeof(TextRender::GlyphInstance),
+        buf.bytes(), 2 * sizeof(TextRender::GlyphInstance)) == 0;
+
+    // Glyphs added later reach UV table, growing it or writing behind uploaded entries
+    for (const char* text : {"{", "}", "~"}) {
+        TextRender::glyph_map_t added;
+        font.layout(text, -1.0f, -1.0f, 0.0f, 0.0f, &added);
+        passed = passed && uvEntryMatches(font.uvTexture(), added.begin()->second[0]);
+    }
+
+    // Shaders consuming records compile
+    ShaderVariants variants(
+        "../shaders/text_instanced.vertexshader", "../shaders/text.fragmentshader", {"SDF"});
+    variants.get(0);
+    variants.get(variants.bit("SDF"));
+
+    passed = passed && glGetError() == GL_NO_ERROR;
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("TextRender - atlas freed with last instance")
+{
+    TextRender* font = new TextRender("../resources/fonts/ARIALMT.ttf", 0);
+    TextRender* other = new TextRender("../resources/fonts/ARIALMT.ttf", 0, GlyphMode::SDF);
+
+    TextRender::glyph_map_t glyphs;
+    font->layout("A", -1.0f, -1.0f, 0.0f, 0.0f, &glyphs);
+    GLuint page = glyphs.begin()->first;
+
+    delete font;
+    bool passed = glIsTexture(page) == GL_TRUE;    // Still shared with other instance
+
+    delete other;
+    passed = passed && glIsTexture(page) == GL_FALSE;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <testsuite.h>
+
+#include <map>
+
+#include "source/render_context.h"
+#include "source/text.h"
+#include "source/text_layer.h"
+
+
+TEST_CASE("TextLayer::batches - spare capacity keeps ranges apart")
+{
+    VertexBuffer buf(1);
+    VertexAttribute posFmt {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute uvFmt {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_DYNAMIC_DRAW);
+    const AttributeBinding* pos = vao.bindBuffer(&posFmt, 0, &buf, sizeof(float));
+    const AttributeBinding* uv = vao.bindBuffer(&uvFmt, 1, &buf, sizeof(float));
+    vao.initialize();
+
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0);
+    TextLayer layer(&font, pos, uv, 1000);
+
+    TextObject* a = layer.create("ab", 0.0f, 0.0f, 0.1f, 0.1f);
+    TextObject* b = layer.create("cd", 0.1f, 0.0f, 0.2f, 0.1f);
+    layer.create("e f", 0.2f, 0.0f, 0.3f, 0.1f);
+
+    // Capacity of "ab" leaves spare vertices, ranges are not contiguous
+    std::map<GLuint, DrawBatch>& batches = layer.batches();
+    bool passed = batches.size() == 1 && batches.begin()->second.size() == 3;
+    passed = passed && batches.begin()->second.counts()[0] == 12;
+    passed = passed && batches.begin()->second.counts()[2] == 12;    // Whitespace not drawn
+
+    // Shorter text stays in place
+    GLint firstB = batches.begin()->second.firsts()[1];
+    b->setText("c");
+    layer.batches();    // Rebuilds ranges in place
+    passed = passed && batches.begin()->second.firsts()[1] == firstB;
+    passed = passed && batches.begin()->second.counts()[1] == 6;
+
+    layer.remove(a);
+    passed = passed && layer.numObjects() == 2 && layer.batches().begin()->second.size() == 2;
+
+    ASSERT_TRUE(passed);
+}
+
+
+TEST_CASE("TextLayer::batches - placeholders replaced by glyphs uploaded elsewhere")
+{
+    VertexBuffer buf(1);
+    VertexAttribute posFmt {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute uvFmt {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_DYNAMIC_DRAW);
+    const AttributeBinding* pos = vao.bindBuffer(&posFmt, 0, &buf, sizeof(float));
+    const AttributeBinding* uv = vao.bindBuffer(&uvFmt, 1, &buf, sizeof(float));
+    vao.initialize();
+
+    TextRender font("../resources/fonts/ARIALMT.ttf", 0);
+    font.rasterizeInBackground(1, MissPolicy::Placeholder);
+    TextLayer layer(&font, pos, uv, 1000);
+
+    // Glyphs are only requested by this layout, placeholders draw nothing
+    layer.create("xyz", 0.0f, 0.0f, 0.1f, 0.1f);
+
+    // Uploads glyphs without the layer noticing
+    font.prewarm("xyz");
+
+    std::map<GLuint, DrawBatch>& batches = layer.batches();
+    bool passed = batches.size() == 1 && batches.begin()->second.size() == 1;
+    passed = passed && batches.begin()->second.counts()[0] == 18;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
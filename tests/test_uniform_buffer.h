@@ -0,0 +1,42 @@
+#include <testsuite.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "source/uniform_buffer.h"
+
+
+TEST_CASE("UniformBuffer - dirty ranges of changed bytes")
+{
+    // std140 layout of { mat4 VP; mat3 normal; float time; vec4 lights[2]; }
+    UniformBlockLayout layout = {0, 160, {}};
+    layout.members["VP"] = {GL_FLOAT_MAT4, 0, 1, 0, 16};
+    layout.members["normal"] = {GL_FLOAT_MAT3, 64, 1, 0, 16};
+    layout.members["time"] = {GL_FLOAT, 112, 1, 0, 0};
+    layout.members["lights"] = {GL_FLOAT_VEC4, 128, 2, 16, 0};
+
+    UniformBuffer buffer(layout, 0);
+    buffer.upload();
+    bool passed = buffer.dirtyRanges().empty();
+
+    // Writing unchanged values marks nothing
+    buffer.set("VP", glm::mat4(0.0f));
+    buffer.set("time", 0.0f);
+    passed = passed && buffer.dirtyRanges().empty();
+
+    buffer.set("time", 1.5f);
+    glm::vec4 light(1.0f);
+    buffer.set("lights", &light, 1, 1);
+    passed = passed && buffer.dirtyRanges() ==
+        std::vector<UniformBuffer::range_t> {{112, 116}, {144, 160}};
+
+    // Columns of mat3 are padded to 16 bytes, padding stays untouched
+    buffer.set("normal", glm::mat3(1.0f));
+    passed = passed && buffer.dirtyRanges() == std::vector<UniformBuffer::range_t> {
+        {64, 76}, {80, 92}, {96, 108}, {112, 116}, {144, 160}};
+
+    buffer.upload();
+    passed = passed && buffer.dirtyRanges().empty() && buffer.id() != 0;
+
+    ASSERT_TRUE(passed);
+}
\ No newline at end of file
@@ -4,11 +4,15 @@
 #include <cstdint>
 
 #include "source/buffer.h"
+#include "source/gl_state.h"
 #include "source/render_context.h"
+#include "source/shader.h"
 
 
 class TestVertexBuffer : public VertexBuffer {
   public:
+    using VertexBuffer::VertexBuffer;
+
     const void* getData() const { return static_cast<void*>(data); }
 };
 
@@ -40,5 +44,151 @@ TEST_CASE("VAO::addData - batchwise")
         }
     }
 
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("VertexBuffer::add - dirty ranges")
+{
+    VertexBuffer buf(16 * sizeof(int));
+
+    int data[4] = {1, 2, 3, 4};
+    buf.add(data, 2 * sizeof(int), sizeof(int), 0, 0);
+    buf.add(data, 2 * sizeof(int), sizeof(int), 0, 8 * sizeof(int));
+    buf.add(data, 2 * sizeof(int), sizeof(int), 0, 2 * sizeof(int));  // adjacent to first
+    buf.add(data, 4 * sizeof(int), sizeof(int), 0, 7 * sizeof(int));  // overlaps second
+
+    const std::vector<VertexBuffer::range_t>& ranges = buf.dirtyRanges();
+    bool passed = ranges.size() == 2;
+    passed = passed && ranges[0] == VertexBuffer::range_t(0, 4 * sizeof(int));
+    passed = passed && ranges[1] == VertexBuffer::range_t(7 * sizeof(int), 11 * sizeof(int));
+
+    buf.use(GL_DYNAMIC_DRAW);
+    passed = passed && buf.dirtyRanges().empty();
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("VAO::reserve - interleaved")
+{
+    TestVertexBuffer buf(1);
+    const int* bufData;
+
+    VAO vao(GL_STATIC_DRAW);
+    VertexAttribute posAttrib = {2, GL_INT, GL_FALSE};
+    VertexAttribute colorAttrib = {1, GL_INT, GL_FALSE};
+    const AttributeBinding* pos = vao.bindBuffer(&posAttrib, 0, &buf, sizeof(int));
+    const AttributeBinding* color = vao.bindBuffer(&colorAttrib, 1, &buf, sizeof(int));
+    vao.initialize();
+
+    VertexView<int> posView = vao.reserve<int>(pos, 4);
+    VertexView<int> colorView = vao.reserve<int>(color, 4);
+    for (int i = 0; i < 4; i++) {
+        posView[i][0] = i;
+        posView[i][1] = i + 10;
+        colorView[i][0] = i + 20;
+    }
+
+    bufData = static_cast<const int*>(buf.getData());
+    bool passed = buf.size() == 12 * sizeof(int);
+    for (int i = 0; i < 4 && passed; i++) {
+        const int* vertex = bufData + i * 3 + pos->offset / sizeof(int);
+        passed = vertex[0] == i && vertex[1] == i + 10;
+        passed = passed && bufData[i * 3 + color->offset / sizeof(int)] == i + 20;
+    }
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("DrawBatch::add - merges contiguous ranges")
+{
+    DrawBatch batch;
+    batch.add(0, 6);
+    batch.add(6, 6);    // Continues previous range
+    batch.add(18, 6);
+    batch.add(12, 6);    // Not contiguous with last range
+
+    bool passed = batch.size() == 3;
+    passed = passed && batch.firsts()[0] == 0 && batch.counts()[0] == 12;
+    passed = passed && batch.firsts()[1] == 18 && batch.counts()[1] == 6;
+    passed = passed && batch.firsts()[2] == 12 && batch.counts()[2] == 6;
+
+    batch.clear();
+    passed = passed && batch.size() == 0;
+
+    ASSERT_TRUE(passed);
+}
+
+static const char* instanceTestVertex = R"(#version 330 core
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 offset;
+void main(){
+    gl_Position = vec4(position + offset, 0.0, 1.0);
+}
+)";
+
+static const char* instanceTestFragment = R"(#version 330 core
+out vec4 color;
+void main(){
+    color = vec4(1.0);
+}
+)";
+
+TEST_CASE("VAO::renderInstanced - base instance")
+{
+    VertexBuffer vertices(1);
+    VertexBuffer instances(1);
+    VertexAttribute posAttrib = {2, GL_FLOAT, GL_FALSE};
+    VertexAttribute offsetAttrib = {2, GL_FLOAT, GL_FALSE};
+    VAO vao(GL_STATIC_DRAW);
+    const AttributeBinding* pos = vao.bindBuffer(&posAttrib, 0, &vertices, sizeof(float));
+    const AttributeBinding* offset =
+        vao.bindBuffer(&offsetAttrib, 1, &instances, sizeof(float), 1);
+    vao.initialize();
+
+    const float corners[6] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f};
+    const float offsets[8] = {0.0f, 0.0f, 0.1f, 0.0f, 0.2f, 0.0f, 0.3f, 0.0f};
+    vao.addData(pos, corners, 3);
+    vao.addData(offset, offsets, 4);
+    vao.end();
+
+    ShaderProgram program(instanceTestVertex, instanceTestFragment);
+    program.use();
+
+    // Without base instance support the per instance pointer is moved instead
+    bool supported = GLEW_VERSION_4_2 || GLEW_ARB_base_instance;
+    void* pointer;
+    vao.renderInstanced(0, 3, 2, 2);
+    glGetVertexAttribPointerv(1, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+    bool passed = (std::size_t)pointer == (supported ? 0 : 2 * offset->stride);
+
+    vao.renderInstanced(0, 3, 2);
+    glGetVertexAttribPointerv(1, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+    passed = passed && pointer == nullptr && glGetError() == GL_NO_ERROR;
+
+    program.disable();
+
+    ASSERT_TRUE(passed);
+}
+
+TEST_CASE("StreamingBuffer - growing keeps bytes written this frame")
+{
+    StreamingBuffer buf(4 * sizeof(int));
+    const int values[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    buf.begin();
+    buf.add(values, 4 * sizeof(int), sizeof(int), 0, 0);
+    buf.add(values + 4, 4 * sizeof(int), sizeof(int), 0, 4 * sizeof(int));    // Grows buffer
+    buf.use(GL_STREAM_DRAW);
+
+    int content[8];
+    glBindBuffer(GL_COPY_READ_BUFFER, buf.id());
+    glGetBufferSubData(GL_COPY_READ_BUFFER, buf.gpuOffset(), sizeof(content), content);
+    GLState::invalidate();
+
+    bool passed = buf.size() == 8 * sizeof(int) && glGetError() == GL_NO_ERROR;
+    for (int i = 0; i < 8 && passed; i++) {
+        passed = content[i] == values[i];
+    }
+
     ASSERT_TRUE(passed);
 }
\ No newline at end of file
@@ -4,6 +4,21 @@
 
 #include <cstdio>
 
+#include "test_atlas.h"
+#include "test_buffer_pool.h"
+#include "test_command_list.h"
+#include "test_convert.h"
+#include "test_face_registry.h"
+#include "test_gl_state.h"
+#include "test_glyph_rasterizer.h"
+#include "test_interleave.h"
+#include "test_mesh.h"
+#include "test_render_queue.h"
+#include "test_shader.h"
+#include "test_shader_variants.h"
+#include "test_text.h"
+#include "test_text_layer.h"
+#include "test_uniform_buffer.h"
 #include "test_vao.h"
 
 